@@ -0,0 +1,576 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <functional>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <stdexcept>
+#include <cctype>
+#include <cstdlib>
+
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+#include <boost/program_options.hpp>
+
+#include "resistance.hpp"
+#include "recipe.hpp"
+#include "equipment.hpp"
+#include "input_file.hpp"
+#include "assignment_algorithm.hpp"
+#include "parallel_assignment.hpp"
+#include "split_assignment.hpp"
+
+#ifndef RECAP_SOURCE_DIR
+#define RECAP_SOURCE_DIR "."
+#endif
+
+/** Workload of the regression gate
+ */
+struct workload
+{
+    std::string name;
+    // run the workload once
+    std::function<void()> run;
+};
+
+/** Measured (or stored) performance of a workload
+ */
+struct measurement
+{
+    double median_ms = 0;
+    double peak_kb = 0;
+    // allowed relative increase of the median time and peak memory
+    double time_tolerance = 0.25;
+    double memory_tolerance = 0.10;
+};
+
+/** Stored performance of all workloads
+ */
+struct baseline
+{
+    std::size_t hardware_threads = 0;
+    std::map<std::string, measurement> cases;
+};
+
+/** Parser of the baseline file.
+ *
+ * The file is a JSON object with a "hardware_threads" number and a "cases" array of objects
+ * with a "name" and numeric fields of measurement (unknown fields are ignored).
+ */
+class baseline_parser
+{
+public:
+    explicit baseline_parser(const std::string& text) : text_(text), pos_(0) {}
+
+    /** Parse the whole file
+     *
+     * @returns stored baseline
+     */
+    baseline parse()
+    {
+        baseline result;
+        parse_object([&](const std::string& key)
+        {
+            if (key == "hardware_threads")
+            {
+                result.hardware_threads = static_cast<std::size_t>(parse_number());
+            }
+            else if (key == "cases")
+            {
+                parse_array([&]()
+                {
+                    std::string name;
+                    measurement value;
+                    parse_object([&](const std::string& field)
+                    {
+                        if (field == "name")
+                        {
+                            name = parse_string();
+                        }
+                        else if (field == "median_ms")
+                        {
+                            value.median_ms = parse_number();
+                        }
+                        else if (field == "peak_kb")
+                        {
+                            value.peak_kb = parse_number();
+                        }
+                        else if (field == "time_tolerance")
+                        {
+                            value.time_tolerance = parse_number();
+                        }
+                        else if (field == "memory_tolerance")
+                        {
+                            value.memory_tolerance = parse_number();
+                        }
+                        else
+                        {
+                            skip_value();
+                        }
+                    });
+                    result.cases[name] = value;
+                });
+            }
+            else
+            {
+                skip_value();
+            }
+        });
+        return result;
+    }
+
+private:
+    std::string text_;
+    std::size_t pos_;
+
+    [[noreturn]] void fail(const std::string& msg)
+    {
+        throw std::runtime_error{ "Invalid baseline at offset " + std::to_string(pos_) + ": " + msg };
+    }
+
+    char peek()
+    {
+        while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_])))
+        {
+            ++pos_;
+        }
+        return pos_ < text_.size() ? text_[pos_] : '\0';
+    }
+
+    void expect(char value)
+    {
+        if (peek() != value)
+        {
+            fail(std::string{ "expected '" } + value + "'");
+        }
+        ++pos_;
+    }
+
+    template<typename Fn>
+    void parse_object(Fn&& parse_field)
+    {
+        expect('{');
+        if (peek() == '}')
+        {
+            ++pos_;
+            return;
+        }
+
+        for (;;)
+        {
+            auto key = parse_string();
+            expect(':');
+            parse_field(key);
+            if (peek() == ',')
+            {
+                ++pos_;
+                continue;
+            }
+            expect('}');
+            return;
+        }
+    }
+
+    template<typename Fn>
+    void parse_array(Fn&& parse_item)
+    {
+        expect('[');
+        if (peek() == ']')
+        {
+            ++pos_;
+            return;
+        }
+
+        for (;;)
+        {
+            parse_item();
+            if (peek() == ',')
+            {
+                ++pos_;
+                continue;
+            }
+            expect(']');
+            return;
+        }
+    }
+
+    std::string parse_string()
+    {
+        expect('"');
+        std::string result;
+        while (pos_ < text_.size() && text_[pos_] != '"')
+        {
+            if (text_[pos_] == '\\' && pos_ + 1 < text_.size())
+            {
+                ++pos_;
+            }
+            result += text_[pos_++];
+        }
+        expect('"');
+        return result;
+    }
+
+    double parse_number()
+    {
+        peek();
+        const char* begin = text_.c_str() + pos_;
+        char* end = nullptr;
+        auto value = std::strtod(begin, &end);
+        if (end == begin)
+        {
+            fail("expected a number");
+        }
+        pos_ += end - begin;
+        return value;
+    }
+
+    void skip_value()
+    {
+        auto next = peek();
+        if (next == '{')
+        {
+            parse_object([&](const std::string&) { skip_value(); });
+        }
+        else if (next == '[')
+        {
+            parse_array([&]() { skip_value(); });
+        }
+        else if (next == '"')
+        {
+            parse_string();
+        }
+        else if (text_.compare(pos_, 4, "true") == 0 || text_.compare(pos_, 4, "null") == 0)
+        {
+            pos_ += 4;
+        }
+        else if (text_.compare(pos_, 5, "false") == 0)
+        {
+            pos_ += 5;
+        }
+        else
+        {
+            parse_number();
+        }
+    }
+};
+
+/** Write @p value to @p path
+ *
+ * @param path Path to the baseline file
+ * @param value Baseline
+ */
+void write_baseline(const std::string& path, const baseline& value)
+{
+    std::ofstream output{ path };
+    if (!output)
+    {
+        throw std::runtime_error{ "Cannot write " + path };
+    }
+
+    output << std::fixed << std::setprecision(2);
+    output << "{" << std::endl;
+    output << "    \"hardware_threads\": " << value.hardware_threads << "," << std::endl;
+    output << "    \"cases\": [" << std::endl;
+    std::size_t index = 0;
+    for (const auto& [name, stored] : value.cases)
+    {
+        output
+            << "        { \"name\": \"" << name << "\""
+            << ", \"median_ms\": " << stored.median_ms
+            << ", \"peak_kb\": " << std::setprecision(0) << stored.peak_kb << std::setprecision(2)
+            << ", \"time_tolerance\": " << stored.time_tolerance
+            << ", \"memory_tolerance\": " << stored.memory_tolerance
+            << " }" << (++index < value.cases.size() ? "," : "") << std::endl;
+    }
+    output << "    ]" << std::endl;
+    output << "}" << std::endl;
+}
+
+/** Create the workloads of the gate
+ *
+ * @param data_dir Directory with recipes.csv and equipment.csv
+ *
+ * @returns list of workloads
+ */
+std::vector<workload> make_workloads(const std::string& data_dir)
+{
+    using namespace recap;
+
+    auto recipes = std::make_shared<std::vector<recipe>>(read_recipes(data_dir + "/recipes.csv"));
+    remove_dominated_recipes(*recipes);
+    auto items = std::make_shared<std::vector<equipment>>(read_equipment(data_dir + "/equipment.csv"));
+
+    // the default layout of recap_cli
+    std::vector<recipe::slot_t> slots(7, recipe::SLOT_ARMOUR);
+    slots.insert(slots.end(), 3, recipe::SLOT_JEWELRY);
+
+    // workload which runs find_minimal_assignment of a new algorithm
+    auto assign = [&](std::string name, resistance required, std::function<std::unique_ptr<assignment_algorithm>()> create)
+    {
+        return workload{ std::move(name), [=]()
+        {
+            auto alg = create();
+            alg->find_minimal_assignment(required, slots, *recipes);
+        } };
+    };
+
+    // workload which runs find_minimal_reassignment of a new algorithm
+    auto reassign = [&](std::string name, resistance current, resistance required, std::function<std::unique_ptr<assignment_algorithm>()> create)
+    {
+        return workload{ std::move(name), [=]()
+        {
+            auto alg = create();
+            alg->find_minimal_reassignment(current, required, *items, *recipes);
+        } };
+    };
+
+    auto parallel = []() { return std::make_unique<parallel_assignment>(); };
+    auto in_place = []() { return std::make_unique<parallel_assignment>(simd::detect_isa(), layer_update::in_place); };
+    auto split = []() { return std::make_unique<split_assignment>(); };
+
+    // resistances of all items in data/equipment.csv
+    resistance current{ 76, 106, 129, 80 };
+
+    return std::vector<workload>{
+        assign("assign 75/75/75/0 parallel", resistance{ 75, 75, 75, 0 }, parallel),
+        assign("assign 75/75/75/0 parallel in-place", resistance{ 75, 75, 75, 0 }, in_place),
+        assign("assign 75/75/75/0 split", resistance{ 75, 75, 75, 0 }, split),
+        assign("assign 75/75/75/10 parallel", resistance{ 75, 75, 75, 10 }, parallel),
+        reassign("reassign 130/140/150/0 parallel", current, resistance{ 130, 140, 150, 0 }, parallel),
+        reassign("reassign 130/140/150/90 parallel", current, resistance{ 130, 140, 150, 90 }, parallel),
+    };
+}
+
+/** Run @p work in a child process @p repeat times (after one warm-up run)
+ *
+ * Each workload runs in its own process, so the peak resident memory of the process
+ * only includes memory of this workload.
+ *
+ * @param work Workload
+ * @param repeat Number of measured runs
+ *
+ * @returns median time and peak memory of the child process
+ */
+measurement measure(const workload& work, std::size_t repeat)
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+    {
+        throw std::runtime_error{ "Cannot create a pipe." };
+    }
+
+    auto pid = fork();
+    if (pid < 0)
+    {
+        throw std::runtime_error{ "Cannot create a process." };
+    }
+
+    if (pid == 0)
+    {
+        close(fds[0]);
+
+        double median = -1;
+        try
+        {
+            work.run();
+
+            std::vector<double> times;
+            for (std::size_t i = 0; i < repeat; ++i)
+            {
+                auto begin = std::chrono::steady_clock::now();
+                work.run();
+                auto end = std::chrono::steady_clock::now();
+                times.push_back(std::chrono::duration<double, std::milli>(end - begin).count());
+            }
+
+            std::sort(times.begin(), times.end());
+            median = times[times.size() / 2];
+        }
+        catch (std::exception& err)
+        {
+            std::cerr << work.name << ": " << err.what() << std::endl;
+        }
+
+        auto written = write(fds[1], &median, sizeof(median));
+        close(fds[1]);
+        _exit(written == sizeof(median) && median >= 0 ? 0 : 1);
+    }
+
+    close(fds[1]);
+    double median = -1;
+    auto read_count = read(fds[0], &median, sizeof(median));
+    close(fds[0]);
+
+    int status = 0;
+    rusage usage{};
+    wait4(pid, &status, 0, &usage);
+    if (read_count != sizeof(median) || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        throw std::runtime_error{ "Workload '" + work.name + "' failed." };
+    }
+
+    measurement result;
+    result.median_ms = median;
+    // ru_maxrss is in kilobytes on Linux
+    result.peak_kb = static_cast<double>(usage.ru_maxrss);
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    namespace po = boost::program_options;
+
+    po::options_description desc{ "Allowed options" };
+    desc.add_options()
+        ("help,h", "show help message")
+        ("baseline,b", po::value<std::string>()->default_value(RECAP_SOURCE_DIR "/bench/perf_baseline.json"), "path to the baseline file")
+        ("data,d", po::value<std::string>()->default_value(RECAP_SOURCE_DIR "/data"), "directory with recipes.csv and equipment.csv")
+        ("repeat,n", po::value<std::size_t>()->default_value(7), "number of measured runs of each workload")
+        ("filter,f", po::value<std::string>(), "only run workloads whose name contains this string")
+        ("update", "store the measured values as the new baseline (tolerances are kept)");
+
+    po::variables_map vm;
+    try
+    {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+    }
+    catch (po::error& err)
+    {
+        std::cerr << "Error: " << err.what() << std::endl;
+        return 1;
+    }
+
+    if (vm.count("help"))
+    {
+        std::cout << desc << std::endl;
+        return 0;
+    }
+
+    auto baseline_path = vm["baseline"].as<std::string>();
+    auto repeat = std::max<std::size_t>(vm["repeat"].as<std::size_t>(), 1);
+    bool update = vm.count("update") > 0;
+
+    try
+    {
+        baseline stored;
+        std::ifstream input{ baseline_path };
+        if (input)
+        {
+            std::stringstream text;
+            text << input.rdbuf();
+            stored = baseline_parser{ text.str() }.parse();
+        }
+        else if (!update)
+        {
+            std::cerr << "Error: cannot read baseline " << baseline_path << " (run with --update to create it)" << std::endl;
+            return 1;
+        }
+
+        auto threads = std::thread::hardware_concurrency();
+        if (!update && stored.hardware_threads != threads)
+        {
+            std::cout
+                << "Warning: the baseline was measured with " << stored.hardware_threads
+                << " hardware threads, this machine has " << threads << std::endl;
+        }
+
+        std::cout
+            << std::left << std::setw(40) << "workload"
+            << std::right
+            << std::setw(12) << "median ms"
+            << std::setw(12) << "baseline"
+            << std::setw(12) << "peak MB"
+            << std::setw(12) << "baseline"
+            << "  result" << std::endl;
+
+        std::size_t regressions = 0;
+        baseline updated = stored;
+        updated.hardware_threads = threads;
+        for (const auto& work : make_workloads(vm["data"].as<std::string>()))
+        {
+            if (vm.count("filter") && work.name.find(vm["filter"].as<std::string>()) == std::string::npos)
+            {
+                continue;
+            }
+
+            auto current = measure(work, repeat);
+            auto it = stored.cases.find(work.name);
+
+            std::string verdict = "new";
+            measurement expected;
+            if (it != stored.cases.end())
+            {
+                expected = it->second;
+                bool is_slower = current.median_ms > expected.median_ms * (1 + expected.time_tolerance);
+                bool is_larger = current.peak_kb > expected.peak_kb * (1 + expected.memory_tolerance);
+                verdict = is_slower && is_larger ? "SLOWER, MORE MEMORY" :
+                    is_slower ? "SLOWER" :
+                    is_larger ? "MORE MEMORY" : "ok";
+                if (is_slower || is_larger)
+                {
+                    ++regressions;
+                }
+            }
+            else if (!update)
+            {
+                // every workload has to be covered by the baseline
+                ++regressions;
+                verdict = "NO BASELINE";
+            }
+
+            std::cout
+                << std::left << std::setw(40) << work.name
+                << std::right << std::fixed << std::setprecision(1)
+                << std::setw(12) << current.median_ms
+                << std::setw(12) << expected.median_ms
+                << std::setw(12) << current.peak_kb / 1024
+                << std::setw(12) << expected.peak_kb / 1024
+                << "  " << verdict << std::endl;
+
+            current.time_tolerance = expected.time_tolerance;
+            current.memory_tolerance = expected.memory_tolerance;
+            updated.cases[work.name] = current;
+        }
+
+        if (update)
+        {
+            write_baseline(baseline_path, updated);
+            std::cout << "Baseline stored in " << baseline_path << std::endl;
+            return 0;
+        }
+
+        if (regressions > 0)
+        {
+            std::cout << regressions << " workload(s) regressed." << std::endl;
+            return 1;
+        }
+        std::cout << "No regressions." << std::endl;
+    }
+    catch (recap::invalid_input_error& err)
+    {
+        std::cerr << err.what() << std::endl;
+        return 1;
+    }
+    catch (io::error::base& err)
+    {
+        std::cerr << err.what() << std::endl;
+        return 1;
+    }
+    catch (std::runtime_error& err)
+    {
+        std::cerr << "Error: " << err.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,507 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <array>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <stdexcept>
+
+#include <boost/program_options.hpp>
+
+#include "resistance.hpp"
+#include "recipe.hpp"
+#include "recipe_store.hpp"
+#include "assignment_algorithm.hpp"
+#include "solve_statistics.hpp"
+#include "perf_counters.hpp"
+#include "parallel_assignment.hpp"
+#include "split_assignment.hpp"
+#include "gather_assignment.hpp"
+#ifdef USE_CUDA
+#include "cuda_assignment.hpp"
+#endif // USE_CUDA
+
+/** One problem instance of the benchmark
+ */
+struct bench_case
+{
+    // name of the case (size, slots and number of recipes)
+    std::string name;
+    recap::resistance required;
+    std::vector<recap::recipe::slot_t> slots;
+    std::size_t recipe_count;
+};
+
+/** Measured run time of an algorithm on a case
+ */
+struct bench_result
+{
+    std::string case_name;
+    std::string algorithm;
+    // number of table cells times number of layers
+    double cells;
+    // number of table cells times number of recipes of each layer
+    double evaluations;
+    double median_ms;
+    double min_ms;
+    // true iff hardware counters have been captured
+    bool has_hardware_counters;
+    // average wall time and hardware counters of each layer in one run
+    std::vector<recap::layer_statistics> layers;
+    // average hardware counters of all layers in one run
+    recap::hardware_counters hardware;
+};
+
+/** Algorithm which can be benchmarked
+ */
+struct bench_algorithm
+{
+    std::string name;
+    // create the algorithm (the argument enables hardware counters if the algorithm supports them)
+    std::function<std::unique_ptr<recap::assignment_algorithm>(bool)> create;
+};
+
+/** Generate @p count recipes (the first one is the null recipe)
+ *
+ * Recipes add one or two resistance types like the recipes in data/recipes.csv. The
+ * recipes are the same for the same @p count.
+ *
+ * @param count Number of recipes (at most 255)
+ *
+ * @returns generated recipes
+ */
+std::vector<recap::recipe> make_recipes(std::size_t count)
+{
+    using namespace recap;
+
+    std::mt19937 gen{ static_cast<std::mt19937::result_type>(count) };
+    std::uniform_int_distribution<int> type_dist{ 0, 3 };
+    std::uniform_int_distribution<int> value_dist{ 8, 40 };
+    std::uniform_int_distribution<int> cost_dist{ 0, 30 };
+    std::uniform_int_distribution<int> slot_dist{ 0, 2 };
+    const std::array<recipe::slot_t, 3> slot_masks{ recipe::SLOT_ALL, recipe::SLOT_ARMOUR, recipe::SLOT_JEWELRY };
+
+    std::vector<recipe> result;
+    result.push_back(recipe{ resistance{ 0, 0, 0, 0 }, 0, recipe::SLOT_ALL });
+    while (result.size() < count)
+    {
+        std::array<resistance::item_t, 4> values{};
+        auto first = type_dist(gen);
+        auto second = type_dist(gen);
+        values[first] = static_cast<resistance::item_t>(value_dist(gen));
+        values[second] = static_cast<resistance::item_t>(std::max<int>(values[second], value_dist(gen) / 2));
+
+        // chaos resistances are lower
+        values[3] /= 2;
+
+        result.push_back(recipe{
+            resistance{ values[0], values[1], values[2], values[3] },
+            static_cast<recipe::cost_t>(cost_dist(gen)),
+            slot_masks[slot_dist(gen)] });
+    }
+    return result;
+}
+
+/** Create a list of slots
+ *
+ * @param armour_count Number of armour slots
+ * @param jewelry_count Number of jewelry slots
+ *
+ * @returns slots
+ */
+std::vector<recap::recipe::slot_t> make_slots(std::size_t armour_count, std::size_t jewelry_count)
+{
+    std::vector<recap::recipe::slot_t> slots(armour_count, recap::recipe::SLOT_ARMOUR);
+    slots.insert(slots.end(), jewelry_count, recap::recipe::SLOT_JEWELRY);
+    return slots;
+}
+
+/** Create benchmark cases
+ *
+ * Each sweep changes one parameter of the base case (the default layout of 7 armour and
+ * 3 jewelry slots with 64 recipes).
+ *
+ * @param full Include the largest tables
+ *
+ * @returns list of cases
+ */
+std::vector<bench_case> make_cases(bool full)
+{
+    using namespace recap;
+
+    struct named_size
+    {
+        std::string name;
+        resistance value;
+    };
+
+    struct named_slots
+    {
+        std::string name;
+        std::size_t armour_count;
+        std::size_t jewelry_count;
+    };
+
+    std::vector<named_size> sizes{
+        { "20/20/20/0", resistance{ 20, 20, 20, 0 } },
+        { "40/40/40/10", resistance{ 40, 40, 40, 10 } },
+        { "60/60/60/20", resistance{ 60, 60, 60, 20 } },
+    };
+    if (full)
+    {
+        sizes.push_back({ "75/75/75/30", resistance{ 75, 75, 75, 30 } });
+        sizes.push_back({ "100/100/100/60", resistance{ 100, 100, 100, 60 } });
+    }
+
+    const std::vector<named_slots> layouts{
+        { "1a", 1, 0 },
+        { "4a", 4, 0 },
+        { "3j", 0, 3 },
+        { "7a3j", 7, 3 },
+        { "12a4j", 12, 4 },
+    };
+
+    const std::vector<std::size_t> recipe_counts{ 16, 64, 255 };
+
+    const std::size_t base_size = 1;
+    const std::size_t base_layout = 3;
+    const std::size_t base_recipes = 1;
+
+    auto make_case = [&](std::size_t size, std::size_t layout, std::size_t recipes)
+    {
+        return bench_case{
+            "size=" + sizes[size].name + " slots=" + layouts[layout].name + " recipes=" + std::to_string(recipe_counts[recipes]),
+            sizes[size].value,
+            make_slots(layouts[layout].armour_count, layouts[layout].jewelry_count),
+            recipe_counts[recipes]
+        };
+    };
+
+    std::vector<bench_case> result;
+    for (std::size_t size = 0; size < sizes.size(); ++size)
+    {
+        result.push_back(make_case(size, base_layout, base_recipes));
+    }
+
+    for (std::size_t layout = 0; layout < layouts.size(); ++layout)
+    {
+        if (layout != base_layout)
+        {
+            result.push_back(make_case(base_size, layout, base_recipes));
+        }
+    }
+
+    for (std::size_t recipes = 0; recipes < recipe_counts.size(); ++recipes)
+    {
+        if (recipes != base_recipes)
+        {
+            result.push_back(make_case(base_size, base_layout, recipes));
+        }
+    }
+    return result;
+}
+
+/** Create all algorithms registered in the command line interface
+ *
+ * @returns list of algorithms
+ */
+std::vector<bench_algorithm> make_algorithms()
+{
+    using namespace recap;
+
+    // parallel algorithm which reads hardware counters in each layer if @p counters is true
+    auto make_parallel = [](layer_update update, layout_kind layout)
+    {
+        return [update, layout](bool counters) -> std::unique_ptr<assignment_algorithm>
+        {
+            auto alg = std::make_unique<parallel_assignment>(simd::detect_isa(), update, layout);
+            alg->set_hardware_counters(counters);
+            return alg;
+        };
+    };
+
+    std::vector<bench_algorithm> result;
+#ifdef USE_CUDA
+    result.push_back({ "cuda", [](bool) { return std::make_unique<cuda_assignment>(); } });
+#endif // USE_CUDA
+    result.push_back({ "parallel", make_parallel(layer_update::double_buffer, layout_kind::dense) });
+    result.push_back({ "tiled", make_parallel(layer_update::double_buffer, layout_kind::tiled) });
+    result.push_back({ "in-place", make_parallel(layer_update::in_place, layout_kind::dense) });
+    result.push_back({ "split", [](bool) { return std::make_unique<split_assignment>(); } });
+    result.push_back({ "gather", [](bool) { return std::make_unique<gather_assignment>(); } });
+    return result;
+}
+
+/** Run @p algorithm on @p test_case @p repeat times (after one warm-up run)
+ *
+ * @param test_case Problem instance
+ * @param algorithm Benchmarked algorithm
+ * @param repeat Number of measured runs
+ * @param counters Capture hardware counters of each layer (if the algorithm supports it)
+ *
+ * @returns measured times
+ */
+bench_result run_case(const bench_case& test_case, const bench_algorithm& algorithm, std::size_t repeat, bool counters)
+{
+    using namespace recap;
+
+    auto recipes = make_recipes(test_case.recipe_count);
+    remove_dominated_recipes(recipes);
+
+    // nominal work of the dynamic programming algorithm over the whole table
+    recipe_store store;
+    store.compile(recipes, test_case.slots, test_case.required);
+    double value_count = static_cast<double>(assignment_algorithm::count_values(test_case.required));
+
+    bench_result result;
+    result.case_name = test_case.name;
+    result.algorithm = algorithm.name;
+    result.cells = value_count * test_case.slots.size();
+    result.evaluations = 0;
+    for (std::size_t i = 0; i < test_case.slots.size(); ++i)
+    {
+        result.evaluations += value_count * store.layer(i).count;
+    }
+
+    auto alg = algorithm.create(counters);
+    alg->find_minimal_assignment(test_case.required, test_case.slots, recipes);
+    alg->clear_solve_stats();
+
+    std::vector<double> times;
+    for (std::size_t i = 0; i < repeat; ++i)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        alg->find_minimal_assignment(test_case.required, test_case.slots, recipes);
+        auto end = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<double, std::milli>(end - begin).count());
+    }
+
+    std::sort(times.begin(), times.end());
+    result.median_ms = times[times.size() / 2];
+    result.min_ms = times.front();
+
+    // average layers with the same index over all runs
+    const auto& stats = alg->solve_stats();
+    result.has_hardware_counters = stats.has_hardware_counters;
+    for (const auto& item : stats.layers)
+    {
+        if (item.layer >= result.layers.size())
+        {
+            result.layers.resize(item.layer + 1);
+        }
+
+        auto& layer = result.layers[item.layer];
+        layer.layer = item.layer;
+        layer.time_ms += item.time_ms / repeat;
+        layer.hardware += item.hardware;
+        result.hardware += item.hardware;
+    }
+
+    auto average = [repeat](recap::hardware_counters& value)
+    {
+        value.cycles /= repeat;
+        value.instructions /= repeat;
+        value.l1d_misses /= repeat;
+        value.llc_misses /= repeat;
+        value.branch_misses /= repeat;
+    };
+
+    average(result.hardware);
+    for (auto& layer : result.layers)
+    {
+        average(layer.hardware);
+    }
+    return result;
+}
+
+/** Print instructions per cycle and events per 1000 instructions of @p value
+ *
+ * @param output Output stream
+ * @param value Hardware counters
+ */
+void print_hardware_counters(std::ostream& output, const recap::hardware_counters& value)
+{
+    output
+        << std::fixed << std::setprecision(2)
+        << std::setw(8) << value.ipc()
+        << std::setw(10) << value.per_kilo_instruction(value.l1d_misses)
+        << std::setw(10) << value.per_kilo_instruction(value.llc_misses)
+        << std::setw(10) << value.per_kilo_instruction(value.branch_misses);
+}
+
+/** Print a row of the result table
+ *
+ * @param output Output stream
+ * @param result Measured result
+ */
+void print_result(std::ostream& output, const bench_result& result)
+{
+    auto seconds = result.median_ms / 1000;
+    output
+        << std::left << std::setw(44) << result.case_name
+        << std::setw(10) << result.algorithm
+        << std::right << std::fixed << std::setprecision(2)
+        << std::setw(12) << result.median_ms
+        << std::setw(12) << result.min_ms
+        << std::setw(12) << result.cells / seconds / 1e6
+        << std::setw(12) << result.evaluations / seconds / 1e6;
+
+    if (!result.has_hardware_counters)
+    {
+        output << std::endl;
+        return;
+    }
+
+    // hardware counters of each layer are under the row of the case
+    print_hardware_counters(output, result.hardware);
+    output << std::endl;
+    for (const auto& layer : result.layers)
+    {
+        output
+            << std::left << std::setw(54) << ("  layer " + std::to_string(layer.layer))
+            << std::right << std::setw(12) << layer.time_ms
+            << std::setw(36) << "";
+        print_hardware_counters(output, layer.hardware);
+        output << std::endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    namespace po = boost::program_options;
+
+    po::options_description desc{ "Allowed options" };
+    desc.add_options()
+        ("help,h", "show help message")
+        ("with,w", po::value<std::string>(), "only run this algorithm (available: parallel, tiled, in-place, split, gather, cuda)")
+        ("filter,f", po::value<std::string>(), "only run cases whose name contains this string")
+        ("repeat,n", po::value<std::size_t>()->default_value(5), "number of measured runs of each case")
+        ("full", "include the largest tables (up to 100/100/100/60)")
+        ("counters", "capture hardware counters in each layer of the parallel algorithms (Linux perf_event_open)")
+        ("csv", po::value<std::string>(), "path to a CSV file where the results are written");
+
+    po::variables_map vm;
+    try
+    {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+    }
+    catch (po::error& err)
+    {
+        std::cerr << "Error: " << err.what() << std::endl;
+        return 1;
+    }
+
+    if (vm.count("help"))
+    {
+        std::cout << desc << std::endl;
+        return 0;
+    }
+
+    auto repeat = std::max<std::size_t>(vm["repeat"].as<std::size_t>(), 1);
+    auto cases = make_cases(vm.count("full") > 0);
+    auto algorithms = make_algorithms();
+
+    auto counters = vm.count("counters") > 0;
+    if (counters && !recap::perf_counters{}.is_available())
+    {
+        std::cerr << "Warning: hardware counters are not available (perf_event_open failed)" << std::endl;
+        counters = false;
+    }
+
+    std::ofstream csv;
+    if (vm.count("csv"))
+    {
+        csv.open(vm["csv"].as<std::string>());
+        if (!csv)
+        {
+            std::cerr << "Error: cannot open " << vm["csv"].as<std::string>() << std::endl;
+            return 1;
+        }
+        csv << "case,algorithm,cells,evaluations,median_ms,min_ms";
+        if (counters)
+        {
+            csv << ",cycles,instructions,l1d_misses,llc_misses,branch_misses";
+        }
+        csv << std::endl;
+    }
+
+    std::cout
+        << std::left << std::setw(44) << "case"
+        << std::setw(10) << "algorithm"
+        << std::right
+        << std::setw(12) << "median ms"
+        << std::setw(12) << "min ms"
+        << std::setw(12) << "Mcells/s"
+        << std::setw(12) << "Mevals/s";
+    if (counters)
+    {
+        std::cout
+            << std::setw(8) << "IPC"
+            << std::setw(10) << "L1D MPKI"
+            << std::setw(10) << "LLC MPKI"
+            << std::setw(10) << "br MPKI";
+    }
+    std::cout << std::endl;
+
+    for (const auto& test_case : cases)
+    {
+        if (vm.count("filter") && test_case.name.find(vm["filter"].as<std::string>()) == std::string::npos)
+        {
+            continue;
+        }
+
+        for (const auto& algorithm : algorithms)
+        {
+            if (vm.count("with") && algorithm.name != vm["with"].as<std::string>())
+            {
+                continue;
+            }
+
+            try
+            {
+                auto result = run_case(test_case, algorithm, repeat, counters);
+                print_result(std::cout, result);
+                if (csv.is_open())
+                {
+                    csv
+                        << result.case_name << "," << result.algorithm << ","
+                        << std::setprecision(17) << result.cells << "," << result.evaluations << ","
+                        << result.median_ms << "," << result.min_ms;
+                    if (counters)
+                    {
+                        const auto& hardware = result.hardware;
+                        csv << ",";
+                        if (result.has_hardware_counters)
+                        {
+                            csv
+                                << hardware.cycles << "," << hardware.instructions << "," << hardware.l1d_misses << ","
+                                << hardware.llc_misses << "," << hardware.branch_misses;
+                        }
+                        else
+                        {
+                            // the algorithm doesn't capture hardware counters
+                            csv << ",,,,";
+                        }
+                    }
+                    csv << std::endl;
+                }
+            }
+            catch (std::runtime_error& err)
+            {
+                // e.g., too many slots for the algorithm
+                std::cout
+                    << std::left << std::setw(44) << test_case.name
+                    << std::setw(10) << algorithm.name
+                    << "skipped: " << err.what() << std::endl;
+            }
+        }
+    }
+
+    return 0;
+}
@@ -1,13 +1,47 @@
 #include "assignment_algorithm.hpp"
 
+recap::assignment recap::assignment_algorithm::find_minimal_assignment(
+    resistance required, 
+    const std::vector<recipe::slot_t>& slots, 
+    const std::vector<recipe>& recipes)
+{
+    return build_table(required, slots, recipes).find_assignment(required, recipes);
+}
+
+std::vector<recap::assignment> recap::assignment_algorithm::find_minimal_assignments(
+    const std::vector<resistance>& required, 
+    const std::vector<recipe::slot_t>& slots, 
+    const std::vector<recipe>& recipes)
+{
+    // find component-wise maximum of all requirements
+    resistance max_resistances = resistance::make_zero();
+    for (auto& req : required)
+    {
+        max_resistances = resistance{
+            std::max(max_resistances.fire(), req.fire()),
+            std::max(max_resistances.cold(), req.cold()),
+            std::max(max_resistances.lightning(), req.lightning()),
+            std::max(max_resistances.chaos(), req.chaos())
+        };
+    }
+
+    const auto& table = build_table(max_resistances, slots, recipes);
+
+    std::vector<assignment> result;
+    result.reserve(required.size());
+    for (auto& req : required)
+    {
+        result.push_back(table.find_assignment(req, recipes));
+    }
+    return result;
+}
+
 recap::assignment recap::assignment_algorithm::find_minimal_reassignment(
     resistance current_resistances, 
     resistance max_resistances, 
     const std::vector<equipment>& items,
     const std::vector<recipe>& recipes)
 {
-    initialize(max_resistances, recipes.size());
-    
     // construct list of only the new items
     std::vector<equipment> new_items;
     new_items.reserve(items.size());
@@ -51,35 +85,67 @@ recap::assignment recap::assignment_algorithm::find_minimal_reassignment(
         return result;
     }
 
-    // try all subsets of new items
-    std::size_t subset_count = 1 << new_items.size();
+    // Each new item either keeps its crafted resistances or gets recrafted. Resistances 
+    // crafted on the items are therefore added to the requirement and each item can 
+    // provide them again at no cost.
     std::vector<recipe::slot_t> slots;
+    std::vector<resistance> crafted;
     slots.reserve(new_items.size());
+    crafted.reserve(new_items.size());
 
-    // remember minimal cost assignment and which slots we've used
+    resistance req = new_req_resistances;
+    for (auto& item : new_items)
+    {
+        slots.push_back(item.slot());
+        crafted.push_back(item.crafted_resistances());
+        req = req + item.crafted_resistances();
+    }
+
+    initialize(req, recipes.size());
+
+    return find_minimal_recrafting(req, slots, crafted, recipes);
+}
+
+recap::assignment recap::assignment_algorithm::find_minimal_recrafting(
+    resistance required, 
+    const std::vector<recipe::slot_t>& slots, 
+    const std::vector<resistance>& crafted, 
+    const std::vector<recipe>& recipes)
+{
+    assert(slots.size() == crafted.size());
+
+    // try all subsets of recrafted slots
+    std::size_t subset_count = 1 << slots.size();
+    std::vector<recipe::slot_t> subset_slots;
+    subset_slots.reserve(slots.size());
+
+    // remember minimal cost assignment
     assignment min_assignment;
     min_assignment.cost() = recipe::MAX_COST;
 
-    for (std::size_t i = 1; i < subset_count; ++i)
+    for (std::size_t i = 0; i < subset_count; ++i)
     {
-        resistance req = new_req_resistances;
+        resistance req = required;
 
         // gather item slots from this subset to an array
-        slots.clear();
-        for (std::size_t j = 0; j < new_items.size(); ++j)
+        subset_slots.clear();
+        for (std::size_t j = 0; j < slots.size(); ++j)
         {
             if ((i & (1 << j)) != 0) 
             {
-                slots.push_back(new_items[j].slot());
-
-                // We're gonna potentially change crafted recipe this item so we have to 
-                // assume resistances crafted on it won't be available.
-                req = req + new_items[j].crafted_resistances();
+                subset_slots.push_back(slots[j]);
+            }
+            else 
+            {
+                // This item keeps its crafted resistances.
+                req = req - crafted[j];
             }
         }
 
         // find minimal cost assignment using current subset of items
-        auto assign = find_minimal_assignment(req, slots, recipes);
+        trace::span span{ "subset", "reassignment", "subset", static_cast<std::int64_t>(i) };
+        ++solve_stats_.reassignment_subsets;
+        auto assign = find_minimal_assignment(req, subset_slots, recipes);
         
         if (assign.cost() < min_assignment.cost())
         {
@@ -5,6 +5,9 @@
 #include "resistance.hpp"
 #include "assignment.hpp"
 #include "equipment.hpp"
+#include "solution_table.hpp"
+#include "solve_statistics.hpp"
+#include "trace.hpp"
 
 namespace recap 
 {
@@ -21,6 +24,15 @@ namespace recap
          */
         virtual const char* name() const = 0;
 
+        /** How costs of tables computed by this algorithm are represented
+         * 
+         * @returns cost_precision::quantized if costs in the tables can be rounded
+         */
+        virtual cost_precision precision() const 
+        {
+            return cost_precision::exact;
+        }
+
         /** Allocate memory for problem instances
          * 
          * @param max_resistances Maximal number of resistances
@@ -28,6 +40,20 @@ namespace recap
          */
         virtual void initialize(resistance max_resistances, std::size_t max_recipes) = 0;
 
+        /** Compute minimal cost of every resistance vector <= @p max_resistances if we 
+         * assign @p recipes to equipment @p slots.
+         * 
+         * @param max_resistances Maximal required resistances
+         * @param slots Free equipment slots where we can apply recipes
+         * @param recipes Available recipes
+         * 
+         * @return table with solutions (valid until the next call of this algorithm)
+         */
+        virtual const solution_table& build_table(
+            resistance max_resistances, 
+            const std::vector<recipe::slot_t>& slots, 
+            const std::vector<recipe>& recipes) = 0;
+
         /** Find assignment of @p recipes to equipment @p slots which minimizes cost and 
          * has at least @p required resistances.
          * 
@@ -40,7 +66,22 @@ namespace recap
         virtual assignment find_minimal_assignment(
             resistance required, 
             const std::vector<recipe::slot_t>& slots, 
-            const std::vector<recipe>& recipes) = 0;
+            const std::vector<recipe>& recipes);
+
+        /** Find minimal cost assignment for each requirement in @p required.
+         * 
+         * The table is only built once for the component-wise maximum of all requirements.
+         * 
+         * @param required List of required resistances
+         * @param slots Free equipment slots where we can apply recipes
+         * @param recipes Available recipes
+         * 
+         * @return assignment for each requirement in @p required (in the same order)
+         */
+        virtual std::vector<assignment> find_minimal_assignments(
+            const std::vector<resistance>& required, 
+            const std::vector<recipe::slot_t>& slots, 
+            const std::vector<recipe>& recipes);
 
         /** Find a way to reach @p max_resistances if we replace all old items in @p items 
          * 
@@ -57,6 +98,41 @@ namespace recap
             const std::vector<equipment>& items,
             const std::vector<recipe>& recipes);
 
+        /** Find assignment of @p recipes to equipment @p slots which minimizes cost and 
+         * has at least @p required resistances if each slot can either keep resistances 
+         * currently crafted on it (at no cost) or be recrafted with any recipe.
+         * 
+         * The default implementation tries all subsets of recrafted slots.
+         * 
+         * @param required Required resistances (including resistances crafted on the items)
+         * @param slots Equipment slots where we can apply recipes
+         * @param crafted Resistances currently crafted in each slot of @p slots
+         * @param recipes Available recipes
+         * 
+         * @return assignment of recipes to recrafted slots or invalid assingment object if assignment is not possible.
+         */
+        virtual assignment find_minimal_recrafting(
+            resistance required, 
+            const std::vector<recipe::slot_t>& slots, 
+            const std::vector<resistance>& crafted, 
+            const std::vector<recipe>& recipes);
+
+        /** Work done by this algorithm since the last call of clear_solve_stats()
+         * 
+         * @returns statistics of all tables computed by this algorithm
+         */
+        inline const solve_statistics& solve_stats() const 
+        {
+            return solve_stats_;
+        }
+
+        /** Reset statistics returned by solve_stats()
+         */
+        inline void clear_solve_stats() 
+        {
+            solve_stats_.clear();
+        }
+
         /** Count number of distinct values <= res
          * 
          * @param res Resistances
@@ -71,6 +147,20 @@ namespace recap
             value_count *= res.chaos() + 1;
             return value_count;
         }
+
+    protected:
+        // Statistics of tables computed since the last call of clear_solve_stats()
+        solve_statistics solve_stats_;
+
+        /** Move statistics of a decorated @p algorithm to the statistics of this algorithm
+         * 
+         * @param algorithm Algorithm used by this algorithm
+         */
+        inline void collect_solve_stats(assignment_algorithm& algorithm) 
+        {
+            solve_stats_.merge(algorithm.solve_stats_);
+            algorithm.clear_solve_stats();
+        }
     };
 }
 
@@ -0,0 +1,129 @@
+#include "caching_assignment.hpp"
+
+#include <algorithm>
+
+recap::caching_assignment::caching_assignment(std::unique_ptr<assignment_algorithm> algorithm, std::size_t max_bytes) :
+    algorithm_(std::move(algorithm)),
+    name_(std::string{ "cached-" } + algorithm_->name()),
+    max_bytes_(max_bytes),
+    size_bytes_(0)
+{
+}
+
+const char* recap::caching_assignment::name() const
+{
+    return name_.c_str();
+}
+
+recap::cost_precision recap::caching_assignment::precision() const
+{
+    return algorithm_->precision();
+}
+
+void recap::caching_assignment::initialize(resistance max_res, std::size_t max_recipes)
+{
+    algorithm_->initialize(max_res, max_recipes);
+}
+
+void recap::caching_assignment::clear()
+{
+    entries_.clear();
+    size_bytes_ = 0;
+}
+
+bool recap::caching_assignment::is_same_problem(
+    const entry& item,
+    std::uint64_t recipes_hash,
+    std::uint64_t slots_hash,
+    const std::vector<recipe::slot_t>& sorted_slots,
+    const std::vector<recipe>& recipes)
+{
+    return item.recipes_hash == recipes_hash &&
+        item.slots_hash == slots_hash &&
+        item.sorted_slots == sorted_slots &&
+        item.recipes == recipes;
+}
+
+const recap::solution_table& recap::caching_assignment::build_table(
+    resistance max_resistances,
+    const std::vector<recipe::slot_t>& slots,
+    const std::vector<recipe>& recipes)
+{
+    // slots are interchangeable so the order doesn't matter
+    auto sorted_slots = slots;
+    std::sort(sorted_slots.begin(), sorted_slots.end());
+
+    auto recipes_hash = hash_recipes(recipes);
+    auto slots_hash = hash_slots(sorted_slots);
+
+    // find a table which contains max_resistances
+    for (auto it = entries_.begin(); it != entries_.end(); ++it)
+    {
+        if (is_same_problem(*it, recipes_hash, slots_hash, sorted_slots, recipes) &&
+            it->table.contains(max_resistances))
+        {
+            ++stats_.hits;
+            ++solve_stats_.tables_reused;
+
+            // move the table to the front of the LRU list
+            entries_.splice(entries_.begin(), entries_, it);
+            return entries_.front().table;
+        }
+    }
+
+    ++stats_.misses;
+
+    const auto& table = algorithm_->build_table(max_resistances, slots, recipes);
+    collect_solve_stats(*algorithm_);
+
+    entry item{ recipes_hash, slots_hash, recipes, sorted_slots, table, 0 };
+    item.table.shrink_to_fit();
+    item.size_bytes = item.table.size_bytes() +
+        item.recipes.capacity() * sizeof(recipe) +
+        item.sorted_slots.capacity() * sizeof(recipe::slot_t);
+
+    // the table won't fit into the cache at all
+    if (item.size_bytes > max_bytes_)
+    {
+        return table;
+    }
+
+    // smaller tables of the same problem won't be used anymore
+    for (auto it = entries_.begin(); it != entries_.end();)
+    {
+        if (is_same_problem(*it, recipes_hash, slots_hash, sorted_slots, recipes) &&
+            item.table.contains(it->table.max_resistances()))
+        {
+            size_bytes_ -= it->size_bytes;
+            it = entries_.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    // remove least recently used tables
+    while (size_bytes_ + item.size_bytes > max_bytes_)
+    {
+        ++stats_.evictions;
+        size_bytes_ -= entries_.back().size_bytes;
+        entries_.pop_back();
+    }
+
+    size_bytes_ += item.size_bytes;
+    solve_stats_.bytes_allocated += item.size_bytes;
+    entries_.push_front(std::move(item));
+    return entries_.front().table;
+}
+
+recap::assignment recap::caching_assignment::find_minimal_recrafting(
+    resistance required,
+    const std::vector<recipe::slot_t>& slots,
+    const std::vector<resistance>& crafted,
+    const std::vector<recipe>& recipes)
+{
+    auto result = algorithm_->find_minimal_recrafting(required, slots, crafted, recipes);
+    collect_solve_stats(*algorithm_);
+    return result;
+}
\ No newline at end of file
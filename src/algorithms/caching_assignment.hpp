@@ -0,0 +1,186 @@
+#ifndef RECAP_CACHING_ASSIGNMENT_HPP_
+#define RECAP_CACHING_ASSIGNMENT_HPP_
+
+#include <vector>
+#include <list>
+#include <memory>
+#include <string>
+#include <cstdint>
+
+#include "recipe.hpp"
+#include "resistance.hpp"
+#include "assignment.hpp"
+#include "solution_table.hpp"
+#include "assignment_algorithm.hpp"
+
+namespace recap
+{
+    /** Cache hit/miss counters
+     */
+    struct cache_statistics
+    {
+        // Number of queries answered from a cached table
+        std::size_t hits = 0;
+        // Number of queries which had to build a new table
+        std::size_t misses = 0;
+        // Number of tables removed to make room for a new table
+        std::size_t evictions = 0;
+    };
+
+    /** Decorator which keeps solved tables of another algorithm in an LRU cache.
+     * 
+     * Tables are identified by the list of recipes and by the multiset of slots. A query 
+     * is answered from a cached table if its required resistances fit inside the table.
+     * The size of the cache is limited by the number of bytes used by the cached tables.
+     */
+    class caching_assignment : public assignment_algorithm
+    {
+    public:
+        /** Create a cache for tables computed by @p algorithm
+         * 
+         * @param algorithm Algorithm which computes the tables
+         * @param max_bytes Maximal number of bytes used by cached tables
+         */
+        caching_assignment(std::unique_ptr<assignment_algorithm> algorithm, std::size_t max_bytes);
+
+        virtual ~caching_assignment() {}
+
+        // Non-copyable
+        caching_assignment(const caching_assignment&) = delete;
+        caching_assignment& operator=(const caching_assignment&) = delete;
+
+        // Movable
+        caching_assignment(caching_assignment&&) = default;
+        caching_assignment& operator=(caching_assignment&&) = default;
+
+        /** Identifier of this algorithms
+         * 
+         * @returns name of this algorithm
+         */
+        const char* name() const override;
+
+        /** How costs of tables computed by the decorated algorithm are represented
+         * 
+         * @returns precision of the decorated algorithm
+         */
+        cost_precision precision() const override;
+
+        /** Allocate memory for problem instances
+         * 
+         * @param max_resistances Maximal number of resistances
+         * @param max_recipes Maximal number of recipes
+         */
+        void initialize(resistance max_resistances, std::size_t max_recipes) override;
+
+        /** Find a cached table which contains @p max_resistances or compute a new table.
+         * 
+         * The table can be computed for a different order of @p slots (see solution_table::slots()).
+         * 
+         * @param max_resistances Maximal required resistances
+         * @param slots Free equipment slots where we can apply recipes
+         * @param recipes Available recipes
+         * 
+         * @return table with solutions (valid until the next call of this algorithm)
+         */
+        const solution_table& build_table(
+            resistance max_resistances, 
+            const std::vector<recipe::slot_t>& slots, 
+            const std::vector<recipe>& recipes) override;
+
+        /** Tables with crafted resistances are not cached, the call is forwarded to the decorated algorithm.
+         * 
+         * @param required Required resistances (including resistances crafted on the items)
+         * @param slots Equipment slots where we can apply recipes
+         * @param crafted Resistances currently crafted in each slot of @p slots
+         * @param recipes Available recipes
+         * 
+         * @return assignment of recipes to recrafted slots or invalid assingment object if assignment is not possible.
+         */
+        assignment find_minimal_recrafting(
+            resistance required, 
+            const std::vector<recipe::slot_t>& slots, 
+            const std::vector<resistance>& crafted, 
+            const std::vector<recipe>& recipes) override;
+
+        /** Cache hit/miss counters
+         * 
+         * @returns counters since the creation of this object
+         */
+        inline const cache_statistics& cache_stats() const 
+        {
+            return stats_;
+        }
+
+        /** Memory used by cached tables
+         * 
+         * @returns number of bytes
+         */
+        inline std::size_t size_bytes() const 
+        {
+            return size_bytes_;
+        }
+
+        /** Maximal memory used by cached tables
+         * 
+         * @returns number of bytes
+         */
+        inline std::size_t max_bytes() const 
+        {
+            return max_bytes_;
+        }
+
+        /** Number of cached tables
+         * 
+         * @returns number of tables in the cache
+         */
+        inline std::size_t size() const 
+        {
+            return entries_.size();
+        }
+
+        /** Remove all tables from the cache
+         */
+        void clear();
+
+    private:
+        struct entry
+        {
+            // hash_recipes() of recipes
+            std::uint64_t recipes_hash;
+            // hash_slots() of sorted slots
+            std::uint64_t slots_hash;
+            std::vector<recipe> recipes;
+            std::vector<recipe::slot_t> sorted_slots;
+            solution_table table;
+            // memory used by this entry
+            std::size_t size_bytes;
+        };
+
+        std::unique_ptr<assignment_algorithm> algorithm_;
+        std::string name_;
+        std::size_t max_bytes_;
+        std::size_t size_bytes_;
+        // cached tables (the most recently used table is first)
+        std::list<entry> entries_;
+        cache_statistics stats_;
+
+        /** Check whether @p item is a table for @p recipes and @p sorted_slots
+         * 
+         * @param item Cached table
+         * @param recipes_hash Hash of @p recipes
+         * @param slots_hash Hash of @p sorted_slots
+         * @param sorted_slots Sorted list of slots
+         * @param recipes Recipes
+         * 
+         * @returns true iff @p item has been computed using the same recipes and slots
+         */
+        static bool is_same_problem(
+            const entry& item, 
+            std::uint64_t recipes_hash, 
+            std::uint64_t slots_hash, 
+            const std::vector<recipe::slot_t>& sorted_slots, 
+            const std::vector<recipe>& recipes);
+    };
+}
+
+#endif // RECAP_CACHING_ASSIGNMENT_HPP_
\ No newline at end of file
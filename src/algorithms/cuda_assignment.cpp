@@ -11,52 +11,67 @@ const char* recap::cuda_assignment::name() const
 
 void recap::cuda_assignment::initialize(resistance max_res, std::size_t max_recipes)
 {
+    trace::span span{ "allocate", "table" };
     auto value_count = count_values(max_res);
 
     // allocate CPU buffers where we will store the result
-    output_cost_.resize(value_count);
-    output_assignment_.resize(value_count * MAX_SLOT_COUNT);
+    auto old_table_bytes = table_.size_bytes();
+    table_.resize(max_res, std::vector<recipe::slot_t>(MAX_SLOT_COUNT, recipe::SLOT_NONE));
 
     // allocate memory on the GPU
     best_cost_.allocate(value_count);
     next_best_cost_.allocate(value_count);
-    best_assignment_.allocate(value_count * MAX_SLOT_COUNT);
-    next_best_assignment_.allocate(value_count * MAX_SLOT_COUNT);
-
-    // allocate memory for recipes
-    buffer_cost_.resize(max_recipes);
-    buffer_slot_.resize(max_recipes);
-    buffer_resist_.resize(max_recipes);
-
-    // allocate memory for recipes on GPU
-    recipe_cost_.allocate(max_recipes);
-    recipe_slot_.allocate(max_recipes);
-    recipe_resist_.allocate(max_recipes);
+    choices_.allocate(value_count * MAX_SLOT_COUNT);
+
+    // allocate memory for recipes on GPU (each group of layers has its own list)
+    recipe_fire_.allocate(max_recipes * MAX_SLOT_COUNT);
+    recipe_cold_.allocate(max_recipes * MAX_SLOT_COUNT);
+    recipe_lightning_.allocate(max_recipes * MAX_SLOT_COUNT);
+    recipe_chaos_.allocate(max_recipes * MAX_SLOT_COUNT);
+    recipe_cost_.allocate(max_recipes * MAX_SLOT_COUNT);
+    recipe_index_.allocate(max_recipes * MAX_SLOT_COUNT);
+
+    // GPU buffers are always reallocated
+    solve_stats_.bytes_allocated += std::max(table_.size_bytes(), old_table_bytes) - old_table_bytes +
+        best_cost_.size_bytes() + 
+        next_best_cost_.size_bytes() + 
+        choices_.size_bytes() + 
+        recipe_fire_.size_bytes() + 
+        recipe_cold_.size_bytes() + 
+        recipe_lightning_.size_bytes() + 
+        recipe_chaos_.size_bytes() + 
+        recipe_cost_.size_bytes() + 
+        recipe_index_.size_bytes();
 }
 
-void recap::cuda_assignment::set_recipes(cuda::input_data& input, const std::vector<recipe>& recipes)
+void recap::cuda_assignment::set_recipes(
+    const std::vector<recipe::slot_t>& slots, 
+    const std::vector<recipe>& recipes, 
+    resistance req)
 {
-    // copy recipes to GPU
-    for (std::size_t i = 0; i < recipes.size(); ++i)
-    {
-        const auto& recipe = recipes[i];
-
-        buffer_cost_[i] = recipe.cost();
-        buffer_slot_[i] = recipe.slots();
-        buffer_resist_[i].x = recipe.resistances().fire();
-        buffer_resist_[i].y = recipe.resistances().cold();
-        buffer_resist_[i].z = recipe.resistances().lightning();
-        buffer_resist_[i].w = recipe.resistances().chaos();
-    }
-    recipe_cost_.copy_to_gpu(buffer_cost_, recipes.size());
-    recipe_slot_.copy_to_gpu(buffer_slot_, recipes.size());
-    recipe_resist_.copy_to_gpu(buffer_resist_, recipes.size());
+    store_.compile(recipes, slots, req);
+
+    // copy recipes of all groups to GPU
+    recipe_fire_.copy_to_gpu(store_.fire(), store_.size());
+    recipe_cold_.copy_to_gpu(store_.cold(), store_.size());
+    recipe_lightning_.copy_to_gpu(store_.lightning(), store_.size());
+    recipe_chaos_.copy_to_gpu(store_.chaos(), store_.size());
+    recipe_cost_.copy_to_gpu(store_.costs(), store_.size());
+    recipe_index_.copy_to_gpu(store_.indices(), store_.size());
+}
 
-    // update input data
-    input.recipes.costs = recipe_cost_.get();
-    input.recipes.slots = recipe_slot_.get();
-    input.recipes.resistances = recipe_resist_.get();
-    input.recipes.count = recipes.size();
+void recap::cuda_assignment::set_layer_recipes(cuda::input_data& input, std::size_t layer)
+{
+    auto group = store_.layer_group(layer);
+    auto begin = store_.group_begin(group);
+
+    input.recipes.fire = recipe_fire_.get() + begin;
+    input.recipes.cold = recipe_cold_.get() + begin;
+    input.recipes.lightning = recipe_lightning_.get() + begin;
+    input.recipes.chaos = recipe_chaos_.get() + begin;
+    input.recipes.costs = recipe_cost_.get() + begin;
+    input.recipes.indices = recipe_index_.get() + begin;
+    input.recipes.count = static_cast<std::uint32_t>(store_.group(group).count);
 }
 
 void recap::cuda_assignment::set_table_size(cuda::input_data& input, resistance req)
@@ -73,26 +88,28 @@ void recap::cuda_assignment::set_table_size(cuda::input_data& input, resistance
 void recap::cuda_assignment::set_table_buffers(cuda::input_data& input, std::size_t value_count)
 {
     // initialize cost to MAX_COST
-    std::fill(output_cost_.begin(), output_cost_.begin() + value_count, recipe::MAX_COST);
-    output_cost_[0] = 0;
+    trace::span span{ "fill", "table", "cells", static_cast<std::int64_t>(value_count) };
+    std::fill(table_.costs(), table_.costs() + value_count, recipe::MAX_COST);
+    table_.costs()[0] = 0;
 
     // copy current cost to GPU
-    best_cost_.copy_to_gpu(output_cost_, value_count);
+    best_cost_.copy_to_gpu(table_.costs(), value_count);
 
     // update input data
     input.best_cost = best_cost_.get();
-    input.best_assignment = best_assignment_.get();
 }
 
-recap::assignment recap::cuda_assignment::find_minimal_assignment(
+const recap::solution_table& recap::cuda_assignment::build_table(
     resistance required, 
     const std::vector<recipe::slot_t>& slots, 
     const std::vector<recipe>& recipes)
 {
+    trace::span build_span{ "build table", "table", "layers", static_cast<std::int64_t>(slots.size()) };
+
     // if we need to allocate more memory
     auto value_count = count_values(required);
-    if (value_count > output_cost_.size() || 
-        buffer_cost_.size() > recipes.size())
+    if (value_count > best_cost_.count() || 
+        recipe_cost_.count() < recipes.size() * MAX_SLOT_COUNT)
     {
         initialize(required, recipes.size());
     }
@@ -112,78 +129,49 @@ recap::assignment recap::cuda_assignment::find_minimal_assignment(
     }
 
     // construct kernel arguments
+    table_.resize(required, slots);
+
     cuda::input_data input;
     set_table_size(input, required);
     set_table_buffers(input, value_count);
-    set_recipes(input, recipes);
+    set_recipes(slots, recipes, required);
 
     cuda::output_data output;
     output.best_cost = next_best_cost_.get();
-    output.best_assignment = next_best_assignment_.get();
 
-    for (std::uint8_t i = 0; i < slots.size(); ++i)
+    auto table_index = solve_stats_.tables_built++;
+    for (std::size_t i = 0; i < slots.size(); ++i)
     {
-        // set current slot
-        input.slot_index = i;
-        input.slot = slots[i];
+        trace::span layer_span{ "layer", "layer", "layer", static_cast<std::int64_t>(i) };
+        auto start = std::chrono::steady_clock::now();
+
+        // set recipes aplicable to the current slot
+        set_layer_recipes(input, i);
+        output.best_recipe = choices_.get() + i * value_count;
 
         // compute table with i slots
         cuda::run_assignment_kernel(input, output);
         CUCHECK(cudaDeviceSynchronize());
 
+        // every cell is evaluated with every recipe of the layer
+        layer_statistics item;
+        item.table = table_index;
+        item.layer = i;
+        item.time_ms = std::chrono::duration<double, std::milli>{ std::chrono::steady_clock::now() - start }.count();
+        item.cells = value_count;
+        item.evaluations = value_count * input.recipes.count;
+        solve_stats_.layers.push_back(item);
+
         // swap buffers
         std::swap(next_best_cost_, best_cost_);
-        std::swap(next_best_assignment_, best_assignment_);
 
         input.best_cost = best_cost_.get();
-        input.best_assignment = best_assignment_.get();
         output.best_cost = next_best_cost_.get();
-        output.best_assignment = next_best_assignment_.get();
     }
 
-    // get results from GPU
-    best_cost_.copy_from_gpu(output_cost_, value_count);
-    best_assignment_.copy_from_gpu(output_assignment_, value_count * MAX_SLOT_COUNT);
-
-    // Count number of distinct resistance values <= required
-    const resistance res_count{ 
-        static_cast<resistance::item_t>(required.fire() + 1), 
-        static_cast<resistance::item_t>(required.cold() + 1), 
-        static_cast<resistance::item_t>(required.lightning() + 1), 
-        static_cast<resistance::item_t>(required.chaos() + 1) 
-    };
-
-    // Convert resistance object to a linear index.
-    // This is a one-to-one mapping from resistances < res_count to [0, value_count - 1]
-    auto to_index = [res_count](resistance res)
-    {
-        std::size_t index = res.fire();
-        index = index * res_count.cold() + res.cold();
-        index = index * res_count.lightning() + res.lightning();
-        index = index * res_count.chaos() + res.chaos();
-        return index;
-    };
-
-    // lookup the solution in the table
-    auto result_index = to_index(required);
-    auto result_cost = output_cost_[result_index];
-    auto result_assignment = &output_assignment_[result_index * MAX_SLOT_COUNT];
-    
-    // convert it to the output type
-    assignment result;
-    result.cost() = result_cost;
-
-    if (result.cost() != recipe::MAX_COST)
-    {
-        for (std::size_t i = 0; i < slots.size(); ++i)
-        {
-            auto& used_recipe = recipes[result_assignment[i]];
-            if (used_recipe.resistances() != resistance::make_zero())
-            {
-                result.assignments().push_back(recipe_assignment{ slots[i], used_recipe });
-            }
-        }
-    }
+    // get results from GPU (choice tables of all layers are stored contiguously)
+    best_cost_.copy_from_gpu(table_.costs(), value_count);
+    choices_.copy_from_gpu(table_.choices(0), value_count * slots.size());
 
-    return result;
+    return table_;
 }
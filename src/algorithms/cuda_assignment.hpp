@@ -7,10 +7,13 @@
 #include <cstdint>
 #include <string>
 #include <exception>
+#include <algorithm>
+#include <chrono>
 
 #include <cuda_runtime.h>
 
 #include "recipe.hpp"
+#include "recipe_store.hpp"
 #include "resistance.hpp"
 #include "assignment.hpp"
 #include "assignment_kernel.hpp"
@@ -128,6 +131,24 @@ namespace recap
             return ptr_;
         }
 
+        /** Get number of allocated items
+         * 
+         * @returns size of the array
+         */
+        std::size_t count() const 
+        {
+            return count_;
+        }
+
+        /** Get size of the allocated memory
+         * 
+         * @returns number of bytes
+         */
+        std::size_t size_bytes() const 
+        {
+            return count_ * sizeof(T);
+        }
+
         /** Copy data from @p range to GPU 
          * 
          * @param range Values to copy
@@ -224,43 +245,58 @@ namespace recap
          */
         void initialize(resistance max_resistances, std::size_t max_recipes) override;
 
-        /** Find assignment of @p recipes to equipment @p slots which minimizes cost and 
-         * has at least @p required resistances.
+        /** Compute minimal cost of every resistance vector <= @p max_resistances if we 
+         * assign @p recipes to equipment @p slots.
+         * 
+         * Improving updates are not counted on the GPU (they are 0 in solve_stats()).
          * 
-         * @param required Required resistances 
+         * @param max_resistances Maximal required resistances
          * @param slots Free equipment slots where we can apply recipes
          * @param recipes Available recipes
          * 
-         * @return assignment of recipes to slots or invalid assingment object if assignment is not possible.
+         * @return table with solutions (valid until the next call of this algorithm)
          */
-        assignment find_minimal_assignment(
-            resistance required, 
+        const solution_table& build_table(
+            resistance max_resistances, 
             const std::vector<recipe::slot_t>& slots, 
             const std::vector<recipe>& recipes) override;
 
     private:
         // CPU memory
-        std::vector<cost_t> output_cost_;
-        std::vector<recipe_index_t> output_assignment_;
-        std::vector<cost_t> buffer_cost_;
-        std::vector<recipe::slot_t> buffer_slot_;
-        std::vector<cuda::vector4<resistance::item_t>> buffer_resist_;
+        solution_table table_;
+        // Recipes of each layer
+        recipe_store store_;
 
         // GPU buffers
         gpu_ptr<cost_t> best_cost_;
         gpu_ptr<cost_t> next_best_cost_;
-        gpu_ptr<recipe_index_t> best_assignment_;
-        gpu_ptr<recipe_index_t> next_best_assignment_;
+        // Recipe used in each table cell of each layer (one table per slot)
+        gpu_ptr<recipe_index_t> choices_;
+        // Arrays of the recipe store (recipes of all layer groups)
+        gpu_ptr<resistance::item_t> recipe_fire_;
+        gpu_ptr<resistance::item_t> recipe_cold_;
+        gpu_ptr<resistance::item_t> recipe_lightning_;
+        gpu_ptr<resistance::item_t> recipe_chaos_;
         gpu_ptr<cost_t> recipe_cost_;
-        gpu_ptr<recipe::slot_t> recipe_slot_;
-        gpu_ptr<cuda::vector4<resistance::item_t>> recipe_resist_;
+        gpu_ptr<recipe_index_t> recipe_index_;
 
-        /** Add recipes to input data
+        /** Compile recipes for @p slots and copy them to the GPU
          * 
-         * @param input Input data
+         * @param slots Slot of each layer
          * @param recipes Available recipes
+         * @param req Required resistances
+         */
+        void set_recipes(
+            const std::vector<recipe::slot_t>& slots, 
+            const std::vector<recipe>& recipes, 
+            resistance req);
+
+        /** Set recipes of layer @p layer in @p input
+         * 
+         * @param input Input data
+         * @param layer Index of the layer
          */
-        void set_recipes(cuda::input_data& input, const std::vector<recipe>& recipes);
+        void set_layer_recipes(cuda::input_data& input, std::size_t layer);
 
         /** Set table size and table dimensions in @p input
          * 
@@ -0,0 +1,221 @@
+#include "gather_assignment.hpp"
+
+recap::gather_assignment::gather_assignment()
+{
+}
+
+const char* recap::gather_assignment::name() const
+{
+    return "gather";
+}
+
+std::size_t recap::gather_assignment::allocated_bytes() const
+{
+    return table_.size_bytes() + next_best_cost_.capacity() * sizeof(cost_t);
+}
+
+void recap::gather_assignment::initialize(resistance max_res, std::size_t)
+{
+    trace::span span{ "allocate", "table" };
+    auto old_bytes = allocated_bytes();
+    table_.resize(max_res, {});
+    next_best_cost_.resize(table_.value_count());
+    solve_stats_.bytes_allocated += std::max(allocated_bytes(), old_bytes) - old_bytes;
+}
+
+const recap::solution_table& recap::gather_assignment::build_table(
+    resistance required,
+    const std::vector<recipe::slot_t>& slots,
+    const std::vector<recipe>& recipes)
+{
+    trace::span build_span{ "build table", "table", "layers", static_cast<std::int64_t>(slots.size()) };
+
+    // Check that we can fit all recipes into index type (KEEP_RECIPE is reserved)
+    if (recipes.size() > solution_table::KEEP_RECIPE)
+    {
+        throw std::runtime_error{ "Recipes won't fit into used index type." };
+    }
+
+    // allocate memory if necessary (cost table and a choice table for each layer)
+    auto allocate_begin = trace::clock::now();
+    auto old_bytes = allocated_bytes();
+    table_.resize(required, slots);
+    auto value_count = table_.value_count();
+    if (value_count > next_best_cost_.size())
+    {
+        next_best_cost_.resize(value_count);
+    }
+    solve_stats_.bytes_allocated += std::max(allocated_bytes(), old_bytes) - old_bytes;
+    if (trace::is_enabled())
+    {
+        trace::record("allocate", "table", allocate_begin, trace::clock::now(), 
+            "bytes", static_cast<std::int64_t>(allocated_bytes()));
+    }
+
+    // slots with the same mask share a list of recipes
+    store_.compile(recipes, slots, required);
+
+    // number of values and distance of consecutive values of each resistance type in the table
+    const std::array<std::size_t, 4> extent{
+        std::size_t{ required.fire() } + 1,
+        std::size_t{ required.cold() } + 1,
+        std::size_t{ required.lightning() } + 1,
+        std::size_t{ required.chaos() } + 1
+    };
+    std::array<std::size_t, 4> stride;
+    stride[3] = 1;
+    for (std::size_t k = 3; k > 0; --k)
+    {
+        stride[k - 1] = stride[k] * extent[k];
+    }
+
+    // rows go along the last resistance type with more than one value (the following types are 0)
+    std::size_t row_dim = 3;
+    while (row_dim > 0 && extent[row_dim] == 1)
+    {
+        --row_dim;
+    }
+    const std::size_t row_length = extent[row_dim];
+    const std::size_t row_count = value_count / row_length;
+
+    // first cell of the row each recipe reads
+    tbb::enumerable_thread_specific<std::vector<std::size_t>> prev_rows;
+
+    // initialize cost to MAX_COST
+    auto best_cost = table_.costs();
+    {
+        trace::span span{ "fill", "table", "cells", static_cast<std::int64_t>(value_count) };
+        std::fill(best_cost, best_cost + value_count, recipe::MAX_COST);
+    }
+
+    // we can always satisfy the requirement of 0 resistances
+    best_cost[0] = 0;
+
+    auto table_index = solve_stats_.tables_built++;
+    cost_t* prev_cost = best_cost;
+    cost_t* next_cost = next_best_cost_.data();
+    for (std::size_t i = 0; i < slots.size(); ++i)
+    {
+        trace::span layer_span{ "layer", "layer", "layer", static_cast<std::int64_t>(i) };
+        auto start = std::chrono::steady_clock::now();
+        std::atomic<std::uint64_t> improvements{ 0 };
+
+        auto layer_recipes = store_.layer(i);
+        auto choice = table_.choices(i);
+        const std::array<const resistance::item_t*, 4> deltas{
+            layer_recipes.fire,
+            layer_recipes.cold,
+            layer_recipes.lightning,
+            layer_recipes.chaos
+        };
+
+        tbb::parallel_for(tbb::blocked_range<std::size_t>{ 0, row_count }, [&](auto&& range)
+        {
+            trace::span span{ "block", "layer", "layer", static_cast<std::int64_t>(i) };
+            auto& rows = prev_rows.local();
+            rows.resize(layer_recipes.count);
+            std::uint64_t range_improvements = 0;
+
+            for (auto row = range.begin(); row != range.end(); ++row)
+            {
+                auto row_begin = row * row_length;
+                for (std::size_t r = 0; r < layer_recipes.count; ++r)
+                {
+                    std::size_t prev_row = 0;
+                    for (std::size_t k = 0; k < row_dim; ++k)
+                    {
+                        auto value = row_begin / stride[k] % extent[k];
+                        prev_row += (value - std::min<std::size_t>(value, deltas[k][r])) * stride[k];
+                    }
+                    rows[r] = prev_row;
+                }
+
+                // compute @p width cells of the row starting at @p begin
+                auto gather = [&](std::size_t begin, auto width)
+                {
+                    const std::size_t count = width;
+
+                    std::array<cost_t, TILE_SIZE> tile_cost;
+                    std::array<recipe_index_t, TILE_SIZE> tile_choice;
+                    std::size_t improved = 0;
+                    for (std::size_t lane = 0; lane < count; ++lane)
+                    {
+                        tile_cost[lane] = recipe::MAX_COST;
+                        tile_choice[lane] = 0;
+                    }
+
+                    for (std::size_t r = 0; r < layer_recipes.count; ++r)
+                    {
+                        auto cost = layer_recipes.costs[r];
+                        auto index = layer_recipes.indices[r];
+                        std::size_t delta = deltas[row_dim][r];
+                        auto src = prev_cost + rows[r];
+
+                        if (begin >= delta)
+                        {
+                            // all cells of the tile read consecutive cells
+                            src += begin - delta;
+                            for (std::size_t lane = 0; lane < count; ++lane)
+                            {
+                                auto candidate = src[lane] + cost;
+                                bool is_better = candidate < tile_cost[lane];
+                                tile_cost[lane] = is_better ? candidate : tile_cost[lane];
+                                tile_choice[lane] = is_better ? index : tile_choice[lane];
+                                improved += is_better;
+                            }
+                        }
+                        else
+                        {
+                            for (std::size_t lane = 0; lane < count; ++lane)
+                            {
+                                auto value = begin + lane;
+                                auto candidate = src[value - std::min(value, delta)] + cost;
+                                bool is_better = candidate < tile_cost[lane];
+                                tile_cost[lane] = is_better ? candidate : tile_cost[lane];
+                                tile_choice[lane] = is_better ? index : tile_choice[lane];
+                                improved += is_better;
+                            }
+                        }
+                    }
+
+                    std::copy(tile_cost.begin(), tile_cost.begin() + count, next_cost + row_begin + begin);
+                    std::copy(tile_choice.begin(), tile_choice.begin() + count, choice + row_begin + begin);
+                    range_improvements += improved;
+                };
+
+                std::size_t begin = 0;
+                for (; begin + TILE_SIZE <= row_length; begin += TILE_SIZE)
+                {
+                    gather(begin, std::integral_constant<std::size_t, TILE_SIZE>{});
+                }
+
+                if (begin < row_length)
+                {
+                    gather(begin, row_length - begin);
+                }
+            }
+
+            improvements += range_improvements;
+        });
+
+        // every cell is evaluated with every recipe of the layer
+        layer_statistics item;
+        item.table = table_index;
+        item.layer = i;
+        item.time_ms = std::chrono::duration<double, std::milli>{ std::chrono::steady_clock::now() - start }.count();
+        item.cells = value_count;
+        item.evaluations = value_count * layer_recipes.count;
+        item.improvements = improvements;
+        solve_stats_.layers.push_back(item);
+
+        std::swap(prev_cost, next_cost);
+    }
+
+    // the last layer is in the second table after an odd number of layers
+    if (slots.size() % 2 == 1)
+    {
+        table_.swap_costs(next_best_cost_);
+    }
+
+    return table_;
+}
@@ -0,0 +1,104 @@
+#ifndef RECAP_GATHER_ASSIGNMENT_HPP_
+#define RECAP_GATHER_ASSIGNMENT_HPP_
+
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <atomic>
+#include <chrono>
+
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+
+#include "recipe.hpp"
+#include "recipe_store.hpp"
+#include "resistance.hpp"
+#include "assignment.hpp"
+#include "assignment_algorithm.hpp"
+
+namespace recap
+{
+    /** Dynamic programming algorithm which computes each cell of a layer independently
+     * (the formulation of the CUDA kernel) on the CPU.
+     *
+     * Each task computes TILE_SIZE consecutive cells of a row of the table at a time. It
+     * keeps their minimal cost and the recipe which achieves it in local variables while
+     * it loops over recipes of the layer (reading cells of the previous layer) and stores
+     * each cell exactly once.
+     */
+    class gather_assignment : public assignment_algorithm
+    {
+    public:
+        // Type used to index recipes during computation
+        using recipe_index_t = std::uint8_t;
+        // Recipe cost type
+        using cost_t = recipe::cost_t;
+
+        // Number of consecutive cells of a row whose minimum is kept in local variables
+        inline static constexpr std::size_t TILE_SIZE = 16;
+
+        gather_assignment();
+        virtual ~gather_assignment() {}
+
+        // Non-copyable
+        gather_assignment(const gather_assignment&) = delete;
+        gather_assignment& operator=(const gather_assignment&) = delete;
+
+        // Movable
+        gather_assignment(gather_assignment&&) = default;
+        gather_assignment& operator=(gather_assignment&&) = default;
+
+        /** Identifier of this algorithms
+         *
+         * @returns name of this algorithm
+         */
+        const char* name() const override;
+
+        /** Allocate memory for problem instances
+         *
+         * @param max_resistances Maximal number of resistances
+         * @param max_recipes Maximal number of recipes
+         */
+        void initialize(resistance max_resistances, std::size_t max_recipes) override;
+
+        /** Compute minimal cost of every resistance vector <= @p max_resistances if we
+         * assign @p recipes to equipment @p slots.
+         *
+         * Rows of the table are cells which only differ in the last resistance type with
+         * more than one value (they are contiguous in memory). Rows are split between
+         * tasks. For each row and each recipe, the row of the previous layer the recipe
+         * reads is found once and cells of the row then read consecutive cells of it
+         * (except for the cells where the resistance is clamped to 0).
+         *
+         * @param max_resistances Maximal required resistances
+         * @param slots Free equipment slots where we can apply recipes
+         * @param recipes Available recipes
+         *
+         * @return table with solutions (valid until the next call of this algorithm)
+         */
+        const solution_table& build_table(
+            resistance max_resistances,
+            const std::vector<recipe::slot_t>& slots,
+            const std::vector<recipe>& recipes) override;
+
+    private:
+        // Costs of the last computed layer and choice tables of all layers
+        solution_table table_;
+        // Costs of the layer which is being computed
+        std::vector<cost_t> next_best_cost_;
+        // Recipes of each layer
+        recipe_store store_;
+
+        /** Memory used by the tables of this algorithm
+         *
+         * @returns number of bytes
+         */
+        std::size_t allocated_bytes() const;
+    };
+}
+
+#endif // RECAP_GATHER_ASSIGNMENT_HPP_
@@ -0,0 +1,142 @@
+#include "layer_engine.hpp"
+
+recap::layer_bounds recap::compute_layer_bounds(
+    resistance required,
+    const recipe_store& store,
+    std::size_t layer_count,
+    const std::vector<resistance>* crafted,
+    bool only_required)
+{
+    layer_bounds bounds;
+
+    // maximal resistances added in each layer
+    bounds.max_delta.assign(layer_count, resistance::make_zero());
+    for (std::size_t i = 0; i < layer_count; ++i)
+    {
+        auto max_delta = store.group_max_resistances(store.layer_group(i));
+        if (crafted != nullptr)
+        {
+            auto delta = (*crafted)[i];
+            max_delta = resistance{
+                std::max(max_delta.fire(), delta.fire()),
+                std::max(max_delta.cold(), delta.cold()),
+                std::max(max_delta.lightning(), delta.lightning()),
+                std::max(max_delta.chaos(), delta.chaos())
+            };
+        }
+        bounds.max_delta[i] = max_delta;
+    }
+
+    // the lowest cell computed in each layer
+    bounds.begin.assign(layer_count, resistance::make_zero());
+    if (only_required)
+    {
+        // go back from the required cell in the last layer
+        auto begin = required;
+        for (std::size_t i = layer_count; i-- > 0;)
+        {
+            bounds.begin[i] = begin;
+
+            // cells of the previous layer used by recipes in this layer
+            begin = begin - bounds.max_delta[i];
+        }
+    }
+
+    // cells > reach[i] in any dimension have MAX_COST in the layer before layer i
+    bounds.reach.assign(layer_count, resistance::make_zero());
+    for (std::size_t i = 1; i < layer_count; ++i)
+    {
+        auto next_reach = bounds.reach[i - 1] + bounds.max_delta[i - 1];
+        bounds.reach[i] = resistance{
+            std::min(next_reach.fire(), required.fire()),
+            std::min(next_reach.cold(), required.cold()),
+            std::min(next_reach.lightning(), required.lightning()),
+            std::min(next_reach.chaos(), required.chaos())
+        };
+    }
+
+    return bounds;
+}
+
+recap::layer_monitor::layer_monitor(
+    std::size_t layer_count,
+    tbb::enumerable_thread_specific<perf_counters>* thread_counters) :
+    layers_(layer_count),
+    thread_counters_(thread_counters)
+{
+}
+
+recap::layer_monitor::block_start recap::layer_monitor::start_block() const
+{
+    block_start start;
+    start.time = clock::now();
+    start.hardware = thread_counters_ != nullptr ? thread_counters_->local().read() : hardware_counters{};
+    return start;
+}
+
+void recap::layer_monitor::finish_block(
+    std::size_t layer,
+    const block_start& start,
+    std::uint64_t cells,
+    std::uint64_t evaluations,
+    std::uint64_t improvements)
+{
+    auto& counter = layers_[layer];
+    auto begin = start.time.time_since_epoch().count();
+    auto end = clock::now().time_since_epoch().count();
+    for (auto value = counter.begin.load(); begin < value && !counter.begin.compare_exchange_weak(value, begin);)
+    {
+    }
+    for (auto value = counter.end.load(); end > value && !counter.end.compare_exchange_weak(value, end);)
+    {
+    }
+    counter.cells += cells;
+    counter.evaluations += evaluations;
+    counter.improvements += improvements;
+    if (thread_counters_ != nullptr)
+    {
+        auto hardware = thread_counters_->local().read() - start.hardware;
+        counter.cycles += hardware.cycles;
+        counter.instructions += hardware.instructions;
+        counter.l1d_misses += hardware.l1d_misses;
+        counter.llc_misses += hardware.llc_misses;
+        counter.branch_misses += hardware.branch_misses;
+    }
+}
+
+void recap::layer_monitor::report(solve_statistics& stats, std::size_t table_index) const
+{
+    if (thread_counters_ != nullptr && thread_counters_->local().is_available())
+    {
+        stats.has_hardware_counters = true;
+    }
+
+    for (std::size_t i = 0; i < layers_.size(); ++i)
+    {
+        const auto& counter = layers_[i];
+        layer_statistics item;
+        item.table = table_index;
+        item.layer = i;
+        item.cells = counter.cells;
+        item.evaluations = counter.evaluations;
+        item.improvements = counter.improvements;
+        item.hardware.cycles = counter.cycles;
+        item.hardware.instructions = counter.instructions;
+        item.hardware.l1d_misses = counter.l1d_misses;
+        item.hardware.llc_misses = counter.llc_misses;
+        item.hardware.branch_misses = counter.branch_misses;
+        if (counter.end > counter.begin)
+        {
+            item.time_ms = std::chrono::duration<double, std::milli>{ clock::duration{ counter.end - counter.begin } }.count();
+
+            // blocks of consecutive layers overlap so layers are shown on their own tracks
+            if (trace::is_enabled())
+            {
+                trace::record_async("layer", "layer", static_cast<std::int64_t>(i),
+                    clock::time_point{ clock::duration{ counter.begin } },
+                    clock::time_point{ clock::duration{ counter.end } });
+            }
+        }
+        stats.layers.push_back(item);
+    }
+}
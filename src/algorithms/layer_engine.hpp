@@ -0,0 +1,924 @@
+#ifndef RECAP_LAYER_ENGINE_HPP_
+#define RECAP_LAYER_ENGINE_HPP_
+
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <atomic>
+#include <chrono>
+#include <limits>
+
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include <tbb/flow_graph.h>
+#include <tbb/enumerable_thread_specific.h>
+
+#include "recipe.hpp"
+#include "recipe_store.hpp"
+#include "resistance.hpp"
+#include "table_layout.hpp"
+#include "solution_table.hpp"
+#include "solve_statistics.hpp"
+#include "perf_counters.hpp"
+#include "layer_kernel.hpp"
+#include "trace.hpp"
+
+namespace recap
+{
+    /** Cells of each layer of a table which have to be computed
+     */
+    struct layer_bounds
+    {
+        // Maximal resistances added in each layer (by a recipe or by keeping crafted resistances)
+        std::vector<resistance> max_delta;
+        // The lowest cell computed in each layer
+        std::vector<resistance> begin;
+        // Cells > reach[i] in any dimension have MAX_COST in the layer before layer i
+        std::vector<resistance> reach;
+    };
+
+    /** Compute bounds of cells computed in each layer of a table
+     *
+     * After layer i, only cells <= the sum of maximal resistances of recipes used in
+     * layers 0..i can have a finite cost. If @p only_required is true, each layer only
+     * computes the backward dependency cone of the @p required cell: the last layer only
+     * needs the @p required cell and each previous layer needs cells >= the lower bound
+     * of the next layer minus the maximal resistances of recipes used in the next layer.
+     *
+     * @param required Maximal required resistances (dimensions of the table)
+     * @param store Recipes compiled for the layers of the table
+     * @param layer_count Number of layers
+     * @param crafted Resistances each slot can keep at no cost or nullptr if slots are empty
+     * @param only_required Only compute cells needed for the @p required cell
+     *
+     * @returns bounds of each layer
+     */
+    layer_bounds compute_layer_bounds(
+        resistance required,
+        const recipe_store& store,
+        std::size_t layer_count,
+        const std::vector<resistance>* crafted,
+        bool only_required);
+
+    /** Work done in each layer of a table by all threads (blocks of a layer run in parallel
+     * and layers can overlap)
+     */
+    class layer_monitor
+    {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        /** Measurements taken at the start of a block
+         */
+        struct block_start
+        {
+            clock::time_point time;
+            hardware_counters hardware;
+        };
+
+        /** Create a monitor of a table with @p layer_count layers
+         *
+         * @param layer_count Number of layers
+         * @param thread_counters Hardware counters of each thread or nullptr if they are not captured
+         */
+        layer_monitor(std::size_t layer_count, tbb::enumerable_thread_specific<perf_counters>* thread_counters);
+
+        /** Start measuring a block on the calling thread
+         *
+         * @returns current time and hardware counters of the calling thread
+         */
+        block_start start_block() const;
+
+        /** Add work done in a block of layer @p layer since @p start
+         *
+         * @param layer Index of the layer
+         * @param start Value returned by start_block() on the same thread
+         * @param cells Number of computed cells
+         * @param evaluations Number of cells relaxed by a recipe
+         * @param improvements Number of evaluations which lowered a cost
+         */
+        void finish_block(
+            std::size_t layer,
+            const block_start& start,
+            std::uint64_t cells,
+            std::uint64_t evaluations,
+            std::uint64_t improvements);
+
+        /** Add statistics of all layers to @p stats (and overlapping spans of the layers
+         * to the trace if it is recorded)
+         *
+         * The time of a layer is measured from the start of its first block to the end of
+         * its last block.
+         *
+         * @param stats Statistics of the algorithm
+         * @param table_index Index of the table in @p stats
+         */
+        void report(solve_statistics& stats, std::size_t table_index) const;
+
+    private:
+        struct counters
+        {
+            std::atomic<clock::rep> begin{ std::numeric_limits<clock::rep>::max() };
+            std::atomic<clock::rep> end{ std::numeric_limits<clock::rep>::min() };
+            std::atomic<std::uint64_t> cells{ 0 };
+            std::atomic<std::uint64_t> evaluations{ 0 };
+            std::atomic<std::uint64_t> improvements{ 0 };
+            std::atomic<std::uint64_t> cycles{ 0 };
+            std::atomic<std::uint64_t> instructions{ 0 };
+            std::atomic<std::uint64_t> l1d_misses{ 0 };
+            std::atomic<std::uint64_t> llc_misses{ 0 };
+            std::atomic<std::uint64_t> branch_misses{ 0 };
+        };
+
+        std::vector<counters> layers_;
+        tbb::enumerable_thread_specific<perf_counters>* thread_counters_;
+    };
+
+    /** Computation of the layers of a table in which only @p D resistance types have more
+     * than one value, with costs of type @p value_t (used by parallel_assignment).
+     *
+     * Resistance types with 0 required resistances are removed from the table. The last of
+     * the remaining dimensions is contiguous in memory. Other dimensions are mapped to memory
+     * by the layout of the table, so rows a recipe reads are found by subtracting the offset
+     * of the recipe unless the layout is tiled.
+     *
+     * Choices of each layer are written to the table. Costs are read from and written to
+     * buffers passed to the steps of the computation.
+     *
+     * @tparam D Number of dimensions with more than one value (1 if there are none)
+     * @tparam value_t Cost type (cost_t or simd::quantized_cost_t)
+     */
+    template<std::size_t D, typename value_t>
+    class layer_engine
+    {
+    public:
+        // Index of the last dimension (it is contiguous in memory)
+        inline static constexpr std::size_t LAST = D - 1;
+        // Number of the first dimensions along which the table is split into blocks
+        inline static constexpr std::size_t B = D - 1 < 2 ? D - 1 : 2;
+        // True iff costs are fixed-point numbers
+        inline static constexpr bool QUANTIZED = std::is_same_v<value_t, simd::quantized_cost_t>;
+
+        using cost_t = recipe::cost_t;
+        using recipe_index_t = solution_table::recipe_index_t;
+        using point_t = std::array<std::size_t, D>;
+        using block_position_t = std::array<std::size_t, B>;
+        using relax_run_t = std::conditional_t<QUANTIZED, simd::relax_run_quantized_t, simd::relax_run_t>;
+
+        /** Box of cells of one layer computed by one task
+         */
+        struct block
+        {
+            // Index of the layer
+            std::size_t layer;
+            // The lowest cell of the box
+            point_t low;
+            // Cells of the box are < high in each dimension
+            point_t high;
+            // Costs of the previous layer
+            const value_t* prev_cost;
+            // Computed costs (cell with index k is stored in next_cost[k - next_offset])
+            value_t* next_cost;
+            std::size_t next_offset;
+            // Choices of the layer
+            recipe_index_t* choices;
+            // Work done in the block
+            std::uint64_t cells = 0;
+            std::uint64_t evaluations = 0;
+            std::uint64_t improvements = 0;
+        };
+
+        /** Prepare computation of a table
+         *
+         * @param required Dimensions of the table (it has to have exactly D non-zero resistance types
+         *                 unless D is 1)
+         * @param crafted Resistances each slot can keep at no cost or nullptr if slots are empty
+         * @param store Recipes compiled for the layers of the table
+         * @param table Table resized to @p required (choices are written to it)
+         * @param bounds Cells computed in each layer
+         * @param cost_scale Quantized cost of a recipe is its cost multiplied by @p cost_scale
+         * @param relax_run Kernel which relaxes a contiguous run of cells
+         * @param monitor Monitor of work done in each layer
+         */
+        layer_engine(
+            resistance required,
+            const std::vector<resistance>* crafted,
+            const recipe_store& store,
+            solution_table& table,
+            const layer_bounds& bounds,
+            cost_t cost_scale,
+            relax_run_t relax_run,
+            layer_monitor& monitor);
+
+        /** Cost of unreachable cells
+         */
+        static inline value_t max_value()
+        {
+            if constexpr (QUANTIZED)
+            {
+                return simd::MAX_QUANTIZED_COST;
+            }
+            else
+            {
+                return recipe::MAX_COST;
+            }
+        }
+
+        /** Number of values in each dimension
+         */
+        inline const point_t& extent() const
+        {
+            return extent_;
+        }
+
+        /** Keep only the computed dimensions of @p res
+         */
+        point_t project(resistance res) const;
+
+        /** Index of @p cell in memory (the same as the index of the full resistance vector in the table)
+         */
+        std::size_t index_of(const point_t& cell) const;
+
+        /** Subtract @p delta from @p cell (the result is clamped to 0)
+         */
+        static point_t subtract(point_t cell, const point_t& delta);
+
+        /** Call @p func with the first cell of each row of box [@p low, @p high) (rows are in the last dimension)
+         */
+        template<typename Func>
+        static void for_each_row(const point_t& low, const point_t& high, Func&& func);
+
+        /** Fill @p best_cost with the costs before the first layer (only the 0 cell is reachable)
+         *
+         * @param best_cost Costs of all cells of the table
+         */
+        void initialize(value_t* best_cost) const;
+
+        /** Check whether the recipe which adds @p delta with @p cost can't improve cells of
+         * @p item between @p first and @p final.
+         *
+         * Costs are non-decreasing in each dimension, so it is enough to compare the cost of the
+         * lowest cell the recipe reads plus its cost with the current cost of the highest cell.
+         *
+         * @returns true iff the recipe can be skipped for all cells in [@p first, @p final]
+         */
+        bool is_useless(const block& item, const point_t& delta, value_t cost, const point_t& first, const point_t& final) const;
+
+        /** Relax cells of @p item with a recipe which adds @p delta with @p cost
+         *
+         * Cells which use unreachable cells of the previous layer are skipped. The recipe is
+         * skipped for the whole block or for all rows of the block with the same values in all
+         * but the last two dimensions if it is useless there (see is_useless()).
+         *
+         * @param item Computed block
+         * @param delta Resistances added by the recipe
+         * @param offset Index of @p delta in a linear layout
+         * @param cost Cost of the recipe
+         * @param index Index recorded in the choice table
+         */
+        void relax(block& item, const point_t& delta, std::size_t offset, value_t cost, recipe_index_t index) const;
+
+        /** Compute costs of cells in box [@p low, @p high) of layer @p layer
+         *
+         * @param layer Index of the layer
+         * @param low The lowest cell of the box
+         * @param high Cells of the box are < high in each dimension
+         * @param prev_cost Costs of the previous layer
+         * @param next_cost Computed costs (cell with index k is stored in next_cost[k - next_offset])
+         * @param next_offset Index of the first cell stored in @p next_cost
+         */
+        void compute_range(
+            std::size_t layer,
+            const point_t& low,
+            const point_t& high,
+            const value_t* prev_cost,
+            value_t* next_cost,
+            std::size_t next_offset) const;
+
+        /** Compute all layers alternating between two cost tables
+         *
+         * Layers are not separated by a barrier. The table is split into blocks of @p block_size
+         * values of the first B dimensions. A block of layer i starts as soon as the blocks of
+         * layer i - 1 it reads have been computed and the blocks of layer i - 1 which read the
+         * costs of layer i - 2 it overwrites have been computed.
+         *
+         * @param layer_costs Two cost tables (the first one contains costs before the first layer)
+         * @param block_size Number of values of each of the first B dimensions in a block
+         *
+         * @returns cost table of the last layer
+         */
+        value_t* run_double_buffer(std::array<value_t*, 2> layer_costs, std::size_t block_size) const;
+
+        /** Compute all layers in one cost table
+         *
+         * Each cell only reads cells which are component-wise smaller (or the same cell). Slabs of
+         * cells with the same values of the first B dimensions are computed in a scratch buffer and
+         * written back (see compute_slab()). Slabs on the same anti-diagonal of this grid are
+         * independent, so the diagonals are processed in descending order and slabs of each
+         * diagonal in parallel.
+         *
+         * @param best_cost Costs before the first layer (costs of the last layer when this returns)
+         *
+         * @returns number of bytes allocated for scratch buffers
+         */
+        std::size_t run_in_place(value_t* best_cost) const;
+
+        /** Compute the slab at @p position of layer @p layer in @p slab and copy it to @p best_cost
+         *
+         * @param layer Index of the layer
+         * @param position Values of the first B dimensions of the slab
+         * @param best_cost Costs of the previous layer (slabs which read the slab have to be computed)
+         * @param slab Scratch buffer
+         */
+        void compute_slab(std::size_t layer, const block_position_t& position, value_t* best_cost, std::vector<value_t>& slab) const;
+
+        /** Storage of quantized layers in the cost table of the table
+         *
+         * A cell of the cost table holds two quantized costs, so two quantized layers
+         * fit into it without any extra memory.
+         *
+         * @returns two consecutive quantized cost tables with value_count() cells each
+         */
+        value_t* quantized_costs() const;
+
+        /** Widen quantized costs of the last layer to costs of the table in place
+         *
+         * The last layer has to be in the first table returned by quantized_costs(). Cell k is
+         * read from bytes [2k, 2k + 2) and written to bytes [4k, 4k + 4) of the same storage,
+         * so the cells are converted in descending order: cells of the upper half of the
+         * remaining range only overwrite costs of already converted cells, so each half is
+         * converted in parallel.
+         */
+        void convert() const;
+
+    private:
+        resistance required_;
+        const std::vector<resistance>* crafted_;
+        const recipe_store& store_;
+        solution_table& table_;
+        cost_t cost_scale_;
+        relax_run_t relax_run_;
+        layer_monitor& monitor_;
+        // Resistance type of each computed dimension
+        std::array<std::size_t, D> active_;
+        std::array<table_layout::dimension, D> dims_;
+        point_t extent_;
+        // Projected bounds of each layer (see layer_bounds)
+        std::vector<point_t> layer_low_;
+        std::vector<point_t> layer_reach_;
+        std::vector<point_t> layer_delta_;
+
+        /** Values of all resistance types of @p res
+         */
+        static inline std::array<std::size_t, 4> components(resistance res)
+        {
+            return std::array<std::size_t, 4>{ res.fire(), res.cold(), res.lightning(), res.chaos() };
+        }
+
+        /** Value of @p cost in the table
+         */
+        value_t to_value(cost_t cost) const;
+
+        /** Add two costs (quantized costs saturate at max_value())
+         */
+        static value_t add(value_t lhs, value_t rhs);
+
+        /** Check whether block @p reader reads cells of block @p target in one dimension
+         * if recipes add at most @p delta
+         */
+        static inline bool reads(std::size_t reader, std::size_t target, std::size_t delta, std::size_t block_size)
+        {
+            return target <= reader && (target + 1) * block_size + delta > reader * block_size;
+        }
+    };
+}
+
+template<std::size_t D, typename value_t>
+recap::layer_engine<D, value_t>::layer_engine(
+    resistance required,
+    const std::vector<resistance>* crafted,
+    const recipe_store& store,
+    solution_table& table,
+    const layer_bounds& bounds,
+    cost_t cost_scale,
+    relax_run_t relax_run,
+    layer_monitor& monitor) :
+    required_(required),
+    crafted_(crafted),
+    store_(store),
+    table_(table),
+    cost_scale_(cost_scale),
+    relax_run_(relax_run),
+    monitor_(monitor)
+{
+    // dimensions with more than 1 value (other dimensions have extent 1 so they don't change the layout)
+    active_.fill(3);
+    std::size_t active_count = 0;
+    for (std::size_t dim = 0; dim < 4; ++dim)
+    {
+        if (components(required)[dim] > 0)
+        {
+            assert(active_count < D);
+            active_[active_count++] = dim;
+        }
+    }
+    assert(active_count == D || (active_count == 0 && D == 1));
+
+    for (std::size_t k = 0; k < D; ++k)
+    {
+        extent_[k] = components(required)[active_[k]] + 1;
+        dims_[k] = table_.layout().dim(active_[k]);
+    }
+
+    for (std::size_t i = 0; i < bounds.begin.size(); ++i)
+    {
+        layer_low_.push_back(project(bounds.begin[i]));
+        layer_reach_.push_back(project(bounds.reach[i]));
+        layer_delta_.push_back(project(bounds.max_delta[i]));
+    }
+}
+
+template<std::size_t D, typename value_t>
+typename recap::layer_engine<D, value_t>::point_t recap::layer_engine<D, value_t>::project(resistance res) const
+{
+    auto values = components(res);
+    point_t result;
+    for (std::size_t k = 0; k < D; ++k)
+    {
+        result[k] = values[active_[k]];
+    }
+    return result;
+}
+
+template<std::size_t D, typename value_t>
+std::size_t recap::layer_engine<D, value_t>::index_of(const point_t& cell) const
+{
+    std::size_t index = 0;
+    for (std::size_t k = 0; k < D; ++k)
+    {
+        index += dims_[k].offset(cell[k]);
+    }
+    return index;
+}
+
+template<std::size_t D, typename value_t>
+typename recap::layer_engine<D, value_t>::point_t recap::layer_engine<D, value_t>::subtract(point_t cell, const point_t& delta)
+{
+    for (std::size_t k = 0; k < D; ++k)
+    {
+        cell[k] = cell[k] > delta[k] ? cell[k] - delta[k] : 0;
+    }
+    return cell;
+}
+
+template<std::size_t D, typename value_t>
+template<typename Func>
+void recap::layer_engine<D, value_t>::for_each_row(const point_t& low, const point_t& high, Func&& func)
+{
+    for (std::size_t k = 0; k + 1 < D; ++k)
+    {
+        if (low[k] >= high[k])
+        {
+            return;
+        }
+    }
+
+    auto row = low;
+    for (;;)
+    {
+        func(row);
+
+        // move to the next row
+        std::size_t k = LAST;
+        for (; k > 0; --k)
+        {
+            if (++row[k - 1] < high[k - 1])
+            {
+                break;
+            }
+            row[k - 1] = low[k - 1];
+        }
+
+        if (k == 0)
+        {
+            return;
+        }
+    }
+}
+
+template<std::size_t D, typename value_t>
+value_t recap::layer_engine<D, value_t>::to_value(cost_t cost) const
+{
+    if constexpr (QUANTIZED)
+    {
+        return static_cast<value_t>(std::lround(cost * cost_scale_));
+    }
+    else
+    {
+        return cost;
+    }
+}
+
+template<std::size_t D, typename value_t>
+value_t recap::layer_engine<D, value_t>::add(value_t lhs, value_t rhs)
+{
+    if constexpr (QUANTIZED)
+    {
+        return static_cast<value_t>(std::min<unsigned>(unsigned{ lhs } + rhs, max_value()));
+    }
+    else
+    {
+        return lhs + rhs;
+    }
+}
+
+template<std::size_t D, typename value_t>
+void recap::layer_engine<D, value_t>::initialize(value_t* best_cost) const
+{
+    auto value_count = table_.value_count();
+    trace::span span{ "fill", "table", "cells", static_cast<std::int64_t>(value_count) };
+    std::fill(best_cost, best_cost + value_count, max_value());
+
+    // we can always satisfy the requirement of 0 resistances
+    best_cost[0] = 0;
+}
+
+template<std::size_t D, typename value_t>
+bool recap::layer_engine<D, value_t>::is_useless(
+    const block& item,
+    const point_t& delta,
+    value_t cost,
+    const point_t& first,
+    const point_t& final) const
+{
+    return add(item.prev_cost[index_of(subtract(first, delta))], cost) >= item.next_cost[index_of(final) - item.next_offset];
+}
+
+template<std::size_t D, typename value_t>
+void recap::layer_engine<D, value_t>::relax(
+    block& item,
+    const point_t& delta,
+    std::size_t offset,
+    value_t cost,
+    recipe_index_t index) const
+{
+    const auto& reach = layer_reach_[item.layer];
+    const auto& low = item.low;
+
+    // cells which use unreachable cells of the previous layer stay at MAX_COST
+    point_t end;
+    point_t last;
+    for (std::size_t k = 0; k < D; ++k)
+    {
+        end[k] = std::min(item.high[k], reach[k] + delta[k] + 1);
+        if (end[k] <= low[k])
+        {
+            return;
+        }
+        last[k] = end[k] - 1;
+    }
+
+    // skip the whole box
+    if (is_useless(item, delta, cost, low, last))
+    {
+        return;
+    }
+
+    // cells with value < delta[LAST] in the last dimension are clamped to 0 in the previous table
+    auto split = std::clamp(delta[LAST], low[LAST], end[LAST]);
+    bool is_linear = table_.layout().is_linear();
+
+    // rows with the same values in the first D - 2 dimensions are visited consecutively
+    bool skip_column = false;
+    for_each_row(low, end, [&](const point_t& row)
+    {
+        // skip all rows of a column
+        if constexpr (D > 2)
+        {
+            if (row[D - 2] == low[D - 2])
+            {
+                auto column_last = row;
+                column_last[D - 2] = last[D - 2];
+                column_last[LAST] = last[LAST];
+                skip_column = is_useless(item, delta, cost, row, column_last);
+            }
+
+            if (skip_column)
+            {
+                return;
+            }
+        }
+
+        // find index of the first cell of this row and of the row we use if we use this recipe
+        auto current_row = row;
+        current_row[LAST] = 0;
+        auto current_index = index_of(current_row);
+
+        bool is_clamped = !is_linear;
+        for (std::size_t k = 0; k + 1 < D; ++k)
+        {
+            is_clamped = is_clamped || current_row[k] < delta[k];
+        }
+        auto prev_index = is_clamped ?
+            index_of(subtract(current_row, delta)) :
+            current_index + delta[LAST] - offset;
+        auto next_row = item.next_cost + (current_index - item.next_offset);
+
+        // clamped cells all use the same cell from the previous table
+        for (auto value = low[LAST]; value < split; ++value)
+        {
+            auto candidate = add(item.prev_cost[prev_index], cost);
+            if (candidate < next_row[value])
+            {
+                next_row[value] = candidate;
+                item.choices[current_index + value] = index;
+                ++item.improvements;
+            }
+        }
+        item.evaluations += end[LAST] - low[LAST];
+
+        // the rest of the row uses a contiguous run of the previous row
+        if (split < end[LAST])
+        {
+            item.improvements += relax_run_(
+                next_row + split,
+                item.choices + current_index + split,
+                item.prev_cost + prev_index + (split - delta[LAST]),
+                end[LAST] - split,
+                cost,
+                index);
+        }
+    });
+}
+
+template<std::size_t D, typename value_t>
+void recap::layer_engine<D, value_t>::compute_range(
+    std::size_t layer,
+    const point_t& low,
+    const point_t& high,
+    const value_t* prev_cost,
+    value_t* next_cost,
+    std::size_t next_offset) const
+{
+    trace::span span{ "block", "layer", "layer", static_cast<std::int64_t>(layer) };
+    auto start = monitor_.start_block();
+
+    block item{ layer, low, high, prev_cost, next_cost, next_offset, table_.choices(layer) };
+
+    // initialize next cost with MAX_COST
+    for_each_row(low, high, [&](const point_t& row)
+    {
+        auto begin = next_cost + (index_of(row) - next_offset);
+        std::fill(begin, begin + (high[LAST] - low[LAST]), max_value());
+        item.cells += high[LAST] - low[LAST];
+    });
+
+    // try all recipes which can improve the solution in this layer
+    auto layer_recipes = store_.layer(layer);
+    std::array<const resistance::item_t*, 4> recipe_values{
+        layer_recipes.fire,
+        layer_recipes.cold,
+        layer_recipes.lightning,
+        layer_recipes.chaos
+    };
+    for (std::size_t r = 0; r < layer_recipes.count; ++r)
+    {
+        point_t delta;
+        for (std::size_t k = 0; k < D; ++k)
+        {
+            delta[k] = recipe_values[active_[k]][r];
+        }
+        relax(item, delta, layer_recipes.offsets[r], to_value(layer_recipes.costs[r]), layer_recipes.indices[r]);
+    }
+
+    // try to keep resistances crafted in this slot (excess resistances are wasted)
+    if (crafted_ != nullptr)
+    {
+        resistance delta{
+            std::min((*crafted_)[layer].fire(), required_.fire()),
+            std::min((*crafted_)[layer].cold(), required_.cold()),
+            std::min((*crafted_)[layer].lightning(), required_.lightning()),
+            std::min((*crafted_)[layer].chaos(), required_.chaos())
+        };
+        relax(item, project(delta), table_.layout().index(delta), 0, solution_table::KEEP_RECIPE);
+    }
+
+    monitor_.finish_block(layer, start, item.cells, item.evaluations, item.improvements);
+}
+
+template<std::size_t D, typename value_t>
+value_t* recap::layer_engine<D, value_t>::run_double_buffer(std::array<value_t*, 2> layer_costs, std::size_t block_size) const
+{
+    auto layer_count = layer_low_.size();
+
+    // number of blocks in each of the first B dimensions
+    std::array<std::size_t, B> block_counts;
+    std::size_t block_count = 1;
+    for (std::size_t k = 0; k < B; ++k)
+    {
+        block_counts[k] = (extent_[k] + block_size - 1) / block_size;
+        block_count *= block_counts[k];
+    }
+
+    // position of a block in the grid of blocks
+    auto block_position = [&](std::size_t block)
+    {
+        block_position_t position;
+        for (std::size_t k = B; k-- > 0;)
+        {
+            position[k] = block % block_counts[k];
+            block /= block_counts[k];
+        }
+        return position;
+    };
+
+    tbb::flow::graph graph;
+    std::vector<std::unique_ptr<tbb::flow::continue_node<tbb::flow::continue_msg>>> nodes;
+    nodes.reserve(layer_count * block_count);
+    for (std::size_t i = 0; i < layer_count; ++i)
+    {
+        for (std::size_t block = 0; block < block_count; ++block)
+        {
+            // cells of the block in the computed part of layer i
+            auto position = block_position(block);
+            auto low = layer_low_[i];
+            auto high = extent_;
+            for (std::size_t k = 0; k < B; ++k)
+            {
+                low[k] = std::max(low[k], position[k] * block_size);
+                high[k] = std::min(high[k], (position[k] + 1) * block_size);
+            }
+
+            nodes.push_back(std::make_unique<tbb::flow::continue_node<tbb::flow::continue_msg>>(graph,
+                [&, i, low, high](const tbb::flow::continue_msg&)
+            {
+                compute_range(i, low, high, layer_costs[i % 2], layer_costs[(i + 1) % 2], 0);
+                return tbb::flow::continue_msg{};
+            }));
+
+            if (i == 0)
+            {
+                continue;
+            }
+
+            // wait for blocks of the previous layer this block reads or whose input it overwrites
+            for (std::size_t prev_block = 0; prev_block < block_count; ++prev_block)
+            {
+                auto prev_position = block_position(prev_block);
+                bool is_read = true;
+                bool is_overwritten = true;
+                for (std::size_t k = 0; k < B; ++k)
+                {
+                    is_read = is_read && reads(position[k], prev_position[k], layer_delta_[i][k], block_size);
+                    is_overwritten = is_overwritten && reads(prev_position[k], position[k], layer_delta_[i - 1][k], block_size);
+                }
+
+                if (is_read || is_overwritten)
+                {
+                    tbb::flow::make_edge(*nodes[(i - 1) * block_count + prev_block], *nodes.back());
+                }
+            }
+        }
+    }
+
+    // blocks of the first layer don't wait for anything
+    for (std::size_t block = 0; block < block_count && block < nodes.size(); ++block)
+    {
+        nodes[block]->try_put(tbb::flow::continue_msg{});
+    }
+    graph.wait_for_all();
+
+    // the last layer is in the second table after an odd number of layers
+    return layer_costs[layer_count % 2];
+}
+
+template<std::size_t D, typename value_t>
+void recap::layer_engine<D, value_t>::compute_slab(
+    std::size_t layer,
+    const block_position_t& position,
+    value_t* best_cost,
+    std::vector<value_t>& slab) const
+{
+    // cells of a slab are in a contiguous range which starts at its first cell in all layouts
+    auto slab_last = extent_;
+    for (std::size_t k = 0; k < D; ++k)
+    {
+        slab_last[k] = k < B ? 0 : extent_[k] - 1;
+    }
+    slab.resize(index_of(slab_last) + 1);
+
+    auto low = layer_low_[layer];
+    auto high = extent_;
+    auto origin = point_t{};
+    for (std::size_t k = 0; k < B; ++k)
+    {
+        low[k] = position[k];
+        high[k] = position[k] + 1;
+        origin[k] = position[k];
+    }
+
+    // the slab reads its own cells so it is computed in the scratch buffer
+    auto slab_offset = index_of(origin);
+    compute_range(layer, low, high, best_cost, slab.data(), slab_offset);
+
+    // slabs which read the previous costs of this slab have already been computed
+    for_each_row(low, high, [&](const point_t& row)
+    {
+        auto row_index = index_of(row);
+        std::copy(
+            slab.begin() + (row_index - slab_offset),
+            slab.begin() + (row_index - slab_offset) + (high[LAST] - low[LAST]),
+            best_cost + row_index);
+    });
+}
+
+template<std::size_t D, typename value_t>
+std::size_t recap::layer_engine<D, value_t>::run_in_place(value_t* best_cost) const
+{
+    tbb::enumerable_thread_specific<std::vector<value_t>> slab_costs;
+
+    for (std::size_t i = 0; i < layer_low_.size(); ++i)
+    {
+        const auto& layer_low = layer_low_[i];
+        if constexpr (B == 2)
+        {
+            // slabs on anti-diagonal first + second = diagonal only read slabs on lower diagonals and themselves
+            std::size_t first_last = extent_[0] - 1;
+            std::size_t second_last = extent_[1] - 1;
+            for (std::size_t diagonal = first_last + second_last + 1; diagonal-- > layer_low[0] + layer_low[1];)
+            {
+                auto first_begin = std::max(layer_low[0], diagonal > second_last ? diagonal - second_last : 0);
+                auto first_end = std::min(first_last, diagonal - layer_low[1]) + 1;
+                tbb::parallel_for(tbb::blocked_range<std::size_t>{ first_begin, first_end, 1 }, [&](auto&& range)
+                {
+                    for (auto first = range.begin(); first != range.end(); ++first)
+                    {
+                        compute_slab(i, block_position_t{ first, diagonal - first }, best_cost, slab_costs.local());
+                    }
+                });
+            }
+        }
+        else if constexpr (B == 1)
+        {
+            // each slab reads lower slabs
+            for (std::size_t first = extent_[0]; first-- > layer_low[0];)
+            {
+                compute_slab(i, block_position_t{ first }, best_cost, slab_costs.local());
+            }
+        }
+        else
+        {
+            compute_slab(i, block_position_t{}, best_cost, slab_costs.local());
+        }
+    }
+
+    // scratch buffers are allocated in each call
+    std::size_t bytes = 0;
+    for (const auto& slab : slab_costs)
+    {
+        bytes += slab.capacity() * sizeof(value_t);
+    }
+    return bytes;
+}
+
+template<std::size_t D, typename value_t>
+value_t* recap::layer_engine<D, value_t>::quantized_costs() const
+{
+    static_assert(QUANTIZED, "Only quantized costs are stored in the cost table.");
+    static_assert(sizeof(cost_t) == 2 * sizeof(value_t) && alignof(cost_t) >= alignof(value_t));
+
+    return reinterpret_cast<value_t*>(table_.costs());
+}
+
+template<std::size_t D, typename value_t>
+void recap::layer_engine<D, value_t>::convert() const
+{
+    static_assert(QUANTIZED, "Only quantized costs have to be converted.");
+
+    const value_t* best_cost = quantized_costs();
+    auto costs = table_.costs();
+    auto unit = 1 / cost_scale_;
+
+    // cells [begin, end) are written to bytes >= 4 * begin >= 2 * end, which only hold quantized costs 
+    // of converted cells (the last cell 0 reads its quantized cost before it is overwritten)
+    for (auto end = table_.value_count(); end > 0;)
+    {
+        auto begin = end > 1 ? (end + 1) / 2 : 0;
+        tbb::parallel_for(tbb::blocked_range<std::size_t>{ begin, end }, [&](auto&& range)
+        {
+            for (auto k = range.begin(); k != range.end(); ++k)
+            {
+                costs[k] = best_cost[k] == max_value() ? recipe::MAX_COST : best_cost[k] * unit;
+            }
+        });
+        end = begin;
+    }
+}
+
+#endif // RECAP_LAYER_ENGINE_HPP_
@@ -1,24 +1,86 @@
 #include "parallel_assignment.hpp"
 
-recap::parallel_assignment::parallel_assignment() 
+recap::parallel_assignment::parallel_assignment() : 
+    parallel_assignment(simd::detect_isa())
 {
 }
 
+recap::parallel_assignment::parallel_assignment(simd::isa kernel_isa) : 
+    parallel_assignment(kernel_isa, layer_update::double_buffer)
+{
+}
+
+recap::parallel_assignment::parallel_assignment(simd::isa kernel_isa, layer_update update) : 
+    parallel_assignment(kernel_isa, update, layout_kind::dense)
+{
+}
+
+recap::parallel_assignment::parallel_assignment(simd::isa kernel_isa, layer_update update, layout_kind layout) : 
+    parallel_assignment(kernel_isa, update, layout, cost_precision::exact)
+{
+}
+
+recap::parallel_assignment::parallel_assignment(
+    simd::isa kernel_isa, 
+    layer_update update, 
+    layout_kind layout, 
+    cost_precision precision) : 
+    kernel_isa_(kernel_isa),
+    relax_run_(simd::get_relax_run(kernel_isa)),
+    relax_run_quantized_(simd::get_relax_run_quantized(kernel_isa)),
+    update_(update),
+    layout_(layout),
+    precision_(precision),
+    cost_scale_(1),
+    cost_tolerance_(0)
+{
+    assert(simd::is_supported(kernel_isa));
+}
+
 const char* recap::parallel_assignment::name() const 
 {
     return "parallel";
 }
 
+void recap::parallel_assignment::set_hardware_counters(bool enabled)
+{
+    if (!enabled)
+    {
+        thread_counters_.reset();
+    }
+    else if (thread_counters_ == nullptr)
+    {
+        thread_counters_ = std::make_unique<tbb::enumerable_thread_specific<perf_counters>>();
+    }
+}
+
+std::size_t recap::parallel_assignment::allocated_bytes() const
+{
+    return table_.size_bytes() + next_best_cost_.capacity() * sizeof(cost_t);
+}
+
 void recap::parallel_assignment::initialize(resistance max_res, std::size_t)
 {
-    // find maximal number of table elements
-    std::size_t element_count = count_values(max_res);
-
-    // resize tables
-    best_cost_.resize(element_count);
-    next_best_cost_.resize(element_count);
-    best_assignment_.resize(element_count);
-    next_best_assignment_.resize(element_count);
+    trace::span span{ "allocate", "table" };
+    auto old_bytes = allocated_bytes();
+
+    // resize tables (find maximal number of table elements including gaps of the layout)
+    table_.resize(max_res, {}, layout_);
+    if (has_second_cost_table())
+    {
+        next_best_cost_.resize(table_.value_count());
+    }
+
+    solve_stats_.bytes_allocated += std::max(allocated_bytes(), old_bytes) - old_bytes;
+}
+
+const recap::solution_table& recap::parallel_assignment::build_table(
+    resistance max_resistances, 
+    const std::vector<recipe::slot_t>& slots, 
+    const std::vector<recipe>& recipes)
+{
+    build(max_resistances, slots, nullptr, recipes, false);
+    return table_;
 }
 
 recap::assignment recap::parallel_assignment::find_minimal_assignment(
@@ -26,139 +88,222 @@ recap::assignment recap::parallel_assignment::find_minimal_assignment(
     const std::vector<recipe::slot_t>& slots, 
     const std::vector<recipe>& recipes)
 {
-    // Count number of distinct resistance values <= required
-    const resistance res_count{ 
-        static_cast<resistance::item_t>(required.fire() + 1), 
-        static_cast<resistance::item_t>(required.cold() + 1), 
-        static_cast<resistance::item_t>(required.lightning() + 1), 
-        static_cast<resistance::item_t>(required.chaos() + 1) 
-    };
+    build(required, slots, nullptr, recipes, true);
+    return table_.find_assignment(required, recipes);
+}
+
+recap::assignment recap::parallel_assignment::find_minimal_recrafting(
+    resistance required, 
+    const std::vector<recipe::slot_t>& slots, 
+    const std::vector<resistance>& crafted, 
+    const std::vector<recipe>& recipes)
+{
+    assert(slots.size() == crafted.size());
+
+    // all subsets of recrafted slots are solved in one pass
+    trace::span span{ "subset", "reassignment", "slots", static_cast<std::int64_t>(slots.size()) };
+    ++solve_stats_.reassignment_subsets;
+    build(required, slots, &crafted, recipes, true);
+    return table_.find_assignment(required, crafted, recipes);
+}
+
+void recap::parallel_assignment::build(
+    resistance required, 
+    const std::vector<recipe::slot_t>& slots, 
+    const std::vector<resistance>* crafted, 
+    const std::vector<recipe>& recipes,
+    bool only_required)
+{
+    trace::span build_span{ "build table", "table", "layers", static_cast<std::int64_t>(slots.size()) };
 
-    // allocate memory if necessary
-    if (count_values(required) > best_cost_.size())
+    // allocate memory if necessary (cost table and a choice table for each layer)
+    auto allocate_begin = trace::clock::now();
+    auto old_bytes = allocated_bytes();
+    table_.resize(required, slots, layout_);
+    auto value_count = table_.value_count();
+    if (has_second_cost_table() && value_count > next_best_cost_.size())
     {
-        initialize(required, recipes.size());
+        next_best_cost_.resize(value_count);
     }
-
-    // Check that we can fit all recipes into index type
-    if (recipes.size() > std::numeric_limits<recipe_index_t>::max())
+    solve_stats_.bytes_allocated += std::max(allocated_bytes(), old_bytes) - old_bytes;
+    if (trace::is_enabled())
     {
-        throw std::runtime_error{ "Recipes won't fit into used index type." };
+        trace::record("allocate", "table", allocate_begin, trace::clock::now(), 
+            "bytes", static_cast<std::int64_t>(allocated_bytes()));
     }
 
-    // Check number of slots
-    if (slots.size() > MAX_SLOT_COUNT)
+    // Check that we can fit all recipes into index type (KEEP_RECIPE is reserved)
+    if (recipes.size() > solution_table::KEEP_RECIPE)
     {
-        throw std::runtime_error{ 
-            "Internal type has memory only for " + 
-            std::to_string(MAX_SLOT_COUNT) +  " slots." };
+        throw std::runtime_error{ "Recipes won't fit into used index type." };
     }
 
-    // initialize cost to MAX_COST
-    std::fill(best_cost_.begin(), best_cost_.end(), recipe::MAX_COST);
+    // slots with the same mask are interchangeable so their layers share a list of recipes
+    // (recipes dominated by another aplicable recipe are never needed in these layers)
+    store_.compile(recipes, slots, required, table_.layout());
+    choose_cost_scale(slots.size());
+
+    // cells computed in each layer
+    auto bounds = compute_layer_bounds(required, store_, slots.size(), crafted, only_required);
+    layer_monitor monitor{ slots.size(), thread_counters_.get() };
 
-    // Convert resistance object to a linear index.
-    // This is a one-to-one mapping from resistances < res_count to [0, value_count - 1]
-    auto to_index = [res_count](resistance res)
+    // dimensions with more than 1 value
+    std::size_t active_count = 
+        (required.fire() > 0) + 
+        (required.cold() > 0) + 
+        (required.lightning() > 0) + 
+        (required.chaos() > 0);
+
+    // run all layers with costs of the same type as @p cost_tag
+    auto run_all_layers = [&](auto cost_tag)
     {
-        std::size_t index = res.fire();
-        index = index * res_count.cold() + res.cold();
-        index = index * res_count.lightning() + res.lightning();
-        index = index * res_count.chaos() + res.chaos();
-        return index;
+        using value_t = decltype(cost_tag);
+
+        // zero-extent dimensions are removed from the computation
+        switch (active_count)
+        {
+        case 4:
+            run_layers<4, value_t>(required, crafted, bounds, monitor);
+            break;
+        case 3:
+            run_layers<3, value_t>(required, crafted, bounds, monitor);
+            break;
+        case 2:
+            run_layers<2, value_t>(required, crafted, bounds, monitor);
+            break;
+        default:
+            run_layers<1, value_t>(required, crafted, bounds, monitor);
+            break;
+        }
     };
 
-    // we can always satisfy the requirement of 0 resistances
-    best_cost_[0] = 0;
+    if (precision_ == cost_precision::quantized)
+    {
+        run_all_layers(simd::quantized_cost_t{});
+    }
+    else 
+    {
+        run_all_layers(cost_t{});
+    }
+
+    monitor.report(solve_stats_, solve_stats_.tables_built++);
+}
 
-    for (std::size_t i = 0; i < slots.size(); ++i)
+void recap::parallel_assignment::choose_cost_scale(std::size_t layer_count)
+{
+    // quantized costs of recipes used in all layers have to add up to less than MAX_QUANTIZED_COST
+    cost_scale_ = 1;
+    cost_tolerance_ = 0;
+    if (precision_ != cost_precision::quantized)
     {
-        // initialize next cost with MAX_COST
-        std::fill(next_best_cost_.begin(), next_best_cost_.end(), recipe::MAX_COST);
+        return;
+    }
 
-        // compute next best costs (with 1 more item)
-        tbb::blocked_rangeNd<resistance::item_t, 4> range{ 
-            tbb::blocked_range<resistance::item_t>{ 0, res_count.fire(), 1 },
-            tbb::blocked_range<resistance::item_t>{ 0, res_count.cold(), 1 },
-            tbb::blocked_range<resistance::item_t>{ 0, res_count.lightning(), 128 },
-            tbb::blocked_range<resistance::item_t>{ 0, res_count.chaos(), 128 },
-        };
-        tbb::simple_partitioner partitioner;
-        tbb::parallel_for(range, [&](auto&& local_range) 
+    cost_t max_total = 0;
+    for (std::size_t i = 0; i < layer_count; ++i)
+    {
+        auto layer_recipes = store_.layer(i);
+        cost_t max_cost = 0;
+        for (std::size_t r = 0; r < layer_recipes.count; ++r)
         {
-            // try all recipes for current resistance
-            for (std::size_t recipe_index = 0; recipe_index < recipes.size(); ++recipe_index)
+            if (!(layer_recipes.costs[r] >= 0) || layer_recipes.costs[r] == recipe::MAX_COST)
             {
-                const auto& recipe = recipes[recipe_index];
-
-                // if this recipe is not aplicable for slot i
-                if ((recipe.slots() & slots[i]) == 0)
-                {
-                    continue; // skip this recipe
-                }
-
-                for (resistance::item_t fire = local_range.dim(0).begin(); fire != local_range.dim(0).end(); ++fire)
-                {
-                    for (resistance::item_t cold = local_range.dim(1).begin(); cold != local_range.dim(1).end(); ++cold)
-                    {
-                        for (resistance::item_t lightning = local_range.dim(2).begin(); lightning != local_range.dim(2).end(); ++lightning)
-                        {
-                            for (resistance::item_t chaos = local_range.dim(3).begin(); chaos != local_range.dim(3).end(); ++chaos)
-                            {
-                                // construct resistance object from the values and find its index
-                                resistance current_resist{ fire, cold, lightning, chaos };
-                                auto current_index = to_index(current_resist);
-                                const auto& current_cost = next_best_cost_[current_index];
-
-                                // find required resistances if we use this recipe
-                                resistance prev_resist = current_resist - recipe.resistances();
-                                auto prev_index = to_index(prev_resist);
-                                const auto& prev_cost = best_cost_[prev_index];
-
-                                // if this path is better
-                                if (prev_cost + recipe.cost() < current_cost)
-                                {
-                                    // replace the recipe
-                                    for (std::size_t j = 0; j < i; ++j)
-                                    {
-                                        next_best_assignment_[current_index][j] = best_assignment_[prev_index][j];
-                                    }
-                                    next_best_assignment_[current_index][i] = static_cast<recipe_index_t>(recipe_index);
-
-                                    // update the cost
-                                    next_best_cost_[current_index] = prev_cost + recipe.cost();
-                                }
-                            }
-                        }
-                    }
-                }
+                throw std::runtime_error{ "Quantized costs have to be finite and non-negative." };
             }
-        }, partitioner);
+            max_cost = std::max(max_cost, layer_recipes.costs[r]);
+        }
+        max_total += max_cost;
+    }
+
+    // rounding adds at most 1/2 in each layer
+    auto budget = static_cast<cost_t>(simd::MAX_QUANTIZED_COST - 1 - layer_count);
+    if (max_total > 0)
+    {
+        cost_scale_ = std::exp2(std::floor(std::log2(budget / max_total)));
+    }
 
-        std::swap(next_best_cost_, best_cost_);
-        std::swap(next_best_assignment_, best_assignment_);
+    // each cost is rounded by at most 1 / (2 * cost_scale_), so the found assignment and 
+    // the optimal assignment can each be off by layer_count / (2 * cost_scale_)
+    for (auto cost : store_.costs())
+    {
+        if (std::nearbyint(cost * cost_scale_) != cost * cost_scale_)
+        {
+            cost_tolerance_ = layer_count / cost_scale_;
+            break;
+        }
     }
+}
 
-    // lookup the solution in the table
-    auto result_index = to_index(required);
-    auto result_cost = best_cost_[result_index];
-    auto result_assignment = best_assignment_[result_index];
-    
-    // convert it to the output type
-    assignment result;
-    result.cost() = result_cost;
+template<std::size_t D, typename value_t>
+void recap::parallel_assignment::run_layers(
+    resistance required, 
+    const std::vector<resistance>* crafted, 
+    const layer_bounds& bounds, 
+    layer_monitor& monitor)
+{
+    using engine_t = layer_engine<D, value_t>;
 
-    if (result.cost() != recipe::MAX_COST)
+    typename engine_t::relax_run_t relax_run;
+    if constexpr (engine_t::QUANTIZED)
     {
-        for (std::size_t i = 0; i < slots.size(); ++i)
+        relax_run = relax_run_quantized_;
+    }
+    else 
+    {
+        relax_run = relax_run_;
+    }
+    engine_t engine{ required, crafted, store_, table_, bounds, cost_scale_, relax_run, monitor };
+
+    // the previous layer is in this table before the first layer (quantized layers are stored in 
+    // the cost table of the table)
+    value_t* best_cost;
+    if constexpr (engine_t::QUANTIZED)
+    {
+        best_cost = engine.quantized_costs();
+    }
+    else 
+    {
+        best_cost = table_.costs();
+    }
+
+    if (update_ == layer_update::double_buffer)
+    {
+        // layers alternate between the two cost tables
+        std::array<value_t*, 2> layer_costs{ best_cost, nullptr };
+        if constexpr (engine_t::QUANTIZED)
         {
-            auto& used_recipe = recipes[result_assignment[i]];
-            if (used_recipe.resistances() != resistance::make_zero())
+            // start in the second half after an odd number of layers so the last layer is in the first half
+            layer_costs[1] = best_cost + table_.value_count();
+            if (bounds.begin.size() % 2 == 1)
             {
-                result.assignments().push_back(recipe_assignment{ slots[i], used_recipe });
+                std::swap(layer_costs[0], layer_costs[1]);
+            }
+        }
+        else 
+        {
+            layer_costs[1] = next_best_cost_.data();
+        }
+        engine.initialize(layer_costs[0]);
+        best_cost = engine.run_double_buffer(layer_costs, BLOCK_SIZE);
+
+        // exact costs of the last layer are returned in the table
+        if constexpr (!engine_t::QUANTIZED)
+        {
+            if (best_cost != table_.costs())
+            {
+                table_.swap_costs(next_best_cost_);
             }
         }
     }
-    
-    return result;
-}
\ No newline at end of file
+    else 
+    {
+        engine.initialize(best_cost);
+        solve_stats_.bytes_allocated += engine.run_in_place(best_cost);
+    }
+
+    if constexpr (engine_t::QUANTIZED)
+    {
+        assert(best_cost == engine.quantized_costs());
+        engine.convert();
+    }
+}
@@ -2,40 +2,85 @@
 #define RECAP_PARALLEL_ASSIGNMENT_HPP_
 
 #include <vector>
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <stdexcept>
 #include <cstdint>
 #include <array>
+#include <memory>
 
-#include <tbb/partitioner.h>
-#include <tbb/parallel_for.h>
-#include <tbb/blocked_range3d.h>
-#define TBB_PREVIEW_BLOCKED_RANGE_ND 1
-#include <tbb/blocked_rangeNd.h>
+#include <tbb/enumerable_thread_specific.h>
 
 #include "recipe.hpp"
+#include "recipe_store.hpp"
 #include "resistance.hpp"
+#include "table_layout.hpp"
 #include "assignment.hpp"
 #include "assignment_algorithm.hpp"
+#include "layer_kernel.hpp"
+#include "layer_engine.hpp"
+#include "perf_counters.hpp"
 
 namespace recap
 {
+    /** How the parallel algorithm stores the layer which is being computed
+     */
+    enum class layer_update
+    {
+        // compute the next layer in a second cost table and swap the tables
+        double_buffer,
+        // overwrite the only cost table in descending order of cells
+        in_place
+    };
+
     /** Dynamic programming algorithm which uses TBB to parallelize the computation.
      */
     class parallel_assignment : public assignment_algorithm
     {
     public:
-        // maximal number of equipment slots
-        inline static constexpr std::size_t MAX_SLOT_COUNT = 16;
-
         // Type used to index recipes during computation
         using recipe_index_t = std::uint8_t;
         // Recipe cost type
         using cost_t = recipe::cost_t;
-        // Type used internally to store assignment
-        using internal_assignment_t = std::array<recipe_index_t, MAX_SLOT_COUNT>;
 
+        // Number of values of each of the first two dimensions in a block scheduled as one task
+        inline static constexpr std::size_t BLOCK_SIZE = 8;
+
+        /** Create the algorithm using the best layer kernel this CPU supports
+         */
         parallel_assignment();
 
+        /** Create the algorithm using layer kernel for instruction set @p kernel_isa
+         * 
+         * @param kernel_isa Instruction set used by the layer kernel (it has to be supported by this CPU)
+         */
+        explicit parallel_assignment(simd::isa kernel_isa);
+
+        /** Create the algorithm using layer kernel for instruction set @p kernel_isa
+         * 
+         * @param kernel_isa Instruction set used by the layer kernel (it has to be supported by this CPU)
+         * @param update How layers are stored during computation (in_place only keeps one cost table)
+         */
+        parallel_assignment(simd::isa kernel_isa, layer_update update);
+
+        /** Create the algorithm using layer kernel for instruction set @p kernel_isa
+         * 
+         * @param kernel_isa Instruction set used by the layer kernel (it has to be supported by this CPU)
+         * @param update How layers are stored during computation (in_place only keeps one cost table)
+         * @param layout Order of cells of the computed tables in memory
+         */
+        parallel_assignment(simd::isa kernel_isa, layer_update update, layout_kind layout);
+
+        /** Create the algorithm using layer kernel for instruction set @p kernel_isa
+         * 
+         * @param kernel_isa Instruction set used by the layer kernel (it has to be supported by this CPU)
+         * @param update How layers are stored during computation (in_place only keeps one cost table)
+         * @param layout Order of cells of the computed tables in memory
+         * @param precision How costs are represented during computation
+         */
+        parallel_assignment(simd::isa kernel_isa, layer_update update, layout_kind layout, cost_precision precision);
+
         virtual ~parallel_assignment() {}
 
         // Non-copyable
@@ -52,6 +97,72 @@ namespace recap
          */
         const char* name() const override;
 
+        /** Instruction set used by the layer kernel
+         * 
+         * @returns instruction set
+         */
+        inline simd::isa kernel_isa() const 
+        {
+            return kernel_isa_;
+        }
+
+        /** How layers are stored during computation
+         * 
+         * @returns layer update mode
+         */
+        inline layer_update update_mode() const 
+        {
+            return update_;
+        }
+
+        /** Order of cells of the computed tables in memory
+         * 
+         * @returns kind of the table layout
+         */
+        inline layout_kind layout() const 
+        {
+            return layout_;
+        }
+
+        /** How costs are represented during computation
+         * 
+         * @returns cost precision
+         */
+        inline cost_precision precision() const override
+        {
+            return precision_;
+        }
+
+        /** Maximal difference between the cost of assignments found in the last computed table 
+         * and the minimal cost (costs of returned assignments are always exact sums of recipe costs)
+         * 
+         * @returns 0 unless quantized costs have been rounded
+         */
+        inline cost_t cost_tolerance() const 
+        {
+            return cost_tolerance_;
+        }
+
+        /** Check whether hardware counters are captured in each layer
+         * 
+         * @returns true iff hardware counters are added to solve_stats()
+         */
+        inline bool hardware_counters_enabled() const 
+        {
+            return thread_counters_ != nullptr;
+        }
+
+        /** Capture hardware performance counters (cycles, instructions, cache and branch misses) of 
+         * all threads while they compute each layer and add them to solve_stats().
+         * 
+         * Counters are read before and after each block of cells, so they don't include the 
+         * rest of the algorithm. Nothing is captured if the kernel doesn't allow to count 
+         * hardware events (see perf_counters).
+         * 
+         * @param enabled True iff the counters should be captured
+         */
+        void set_hardware_counters(bool enabled);
+
         /** Allocate memory for problem instances
          * 
          * @param max_resistances Maximal number of resistances
@@ -59,9 +170,26 @@ namespace recap
          */
         void initialize(resistance max_resistances, std::size_t max_recipes) override;
 
+        /** Compute minimal cost of every resistance vector <= @p max_resistances if we 
+         * assign @p recipes to equipment @p slots.
+         * 
+         * @param max_resistances Maximal required resistances
+         * @param slots Free equipment slots where we can apply recipes
+         * @param recipes Available recipes
+         * 
+         * @return table with solutions (valid until the next call of this algorithm)
+         */
+        const solution_table& build_table(
+            resistance max_resistances, 
+            const std::vector<recipe::slot_t>& slots, 
+            const std::vector<recipe>& recipes) override;
+
         /** Find assignment of @p recipes to equipment @p slots which minimizes cost and 
          * has at least @p required resistances.
          * 
+         * Only the cells which can influence the @p required cell are computed in each layer
+         * (see build()).
+         * 
          * @param required Required resistances 
          * @param slots Free equipment slots where we can apply recipes
          * @param recipes Available recipes
@@ -73,11 +201,111 @@ namespace recap
             const std::vector<recipe::slot_t>& slots, 
             const std::vector<recipe>& recipes) override;
 
+        /** Find assignment of @p recipes to equipment @p slots which minimizes cost and 
+         * has at least @p required resistances if each slot can either keep resistances 
+         * currently crafted on it (at no cost) or be recrafted with any recipe.
+         * 
+         * Keeping crafted resistances is just another transition in each layer so this 
+         * only needs one pass over the table. Only the cells which can influence the 
+         * @p required cell are computed in each layer.
+         * 
+         * @param required Required resistances (including resistances crafted on the items)
+         * @param slots Equipment slots where we can apply recipes
+         * @param crafted Resistances currently crafted in each slot of @p slots
+         * @param recipes Available recipes
+         * 
+         * @return assignment of recipes to recrafted slots or invalid assingment object if assignment is not possible.
+         */
+        assignment find_minimal_recrafting(
+            resistance required, 
+            const std::vector<recipe::slot_t>& slots, 
+            const std::vector<resistance>& crafted, 
+            const std::vector<recipe>& recipes) override;
+
     private:
-        std::vector<cost_t> best_cost_;
+        simd::isa kernel_isa_;
+        simd::relax_run_t relax_run_;
+        simd::relax_run_quantized_t relax_run_quantized_;
+        layer_update update_;
+        layout_kind layout_;
+        cost_precision precision_;
+        // Quantized cost of a recipe is its cost multiplied by cost_scale_ (a power of two)
+        cost_t cost_scale_;
+        cost_t cost_tolerance_;
+        // Costs of the last computed layer and choice tables of all layers
+        solution_table table_;
+        // Costs of the layer which is being computed (unused if layers are updated in place or 
+        // quantized, two quantized layers are stored in the cost table of table_)
         std::vector<cost_t> next_best_cost_;
-        std::vector<internal_assignment_t> best_assignment_;
-        std::vector<internal_assignment_t> next_best_assignment_;
+        // Recipes of each layer
+        recipe_store store_;
+        // Hardware counters of each thread (nullptr unless they are captured)
+        std::unique_ptr<tbb::enumerable_thread_specific<perf_counters>> thread_counters_;
+
+        /** Memory used by the tables and buffers of this algorithm
+         * 
+         * @returns number of bytes
+         */
+        std::size_t allocated_bytes() const;
+
+        /** Check whether layers need a cost table besides the cost table of table_
+         * 
+         * @returns true iff exact costs are double buffered
+         */
+        inline bool has_second_cost_table() const 
+        {
+            return update_ == layer_update::double_buffer && precision_ == cost_precision::exact;
+        }
+
+        /** Run the dynamic programming algorithm
+         * 
+         * If @p only_required is true, each layer only computes the backward dependency cone 
+         * of the @p required cell (see compute_layer_bounds()). The table can then only be used 
+         * to find the assignment for @p required.
+         *
+         * Layers are computed by layer_engine specialized for the number of resistance types 
+         * with non-zero required resistances and for the cost type of precision(). Work done 
+         * in each layer is added to solve_stats_.
+         *
+         * @param required Maximal required resistances 
+         * @param slots Equipment slots where we can apply recipes
+         * @param crafted Resistances each slot can keep at no cost or nullptr if slots are empty
+         * @param recipes Available recipes
+         * @param only_required Only compute cells needed for the @p required cell
+         */
+        void build(
+            resistance required, 
+            const std::vector<recipe::slot_t>& slots, 
+            const std::vector<resistance>* crafted, 
+            const std::vector<recipe>& recipes,
+            bool only_required);
+
+        /** Choose cost_scale_ and cost_tolerance_ for recipes compiled in store_
+         * 
+         * Quantized costs are rounded to multiples of 1 / cost_scale_, where cost_scale_ is the 
+         * largest power of two for which no reachable sum of costs saturates. Exact costs use 
+         * scale 1 and tolerance 0.
+         * 
+         * @param layer_count Number of layers of the table
+         */
+        void choose_cost_scale(std::size_t layer_count);
+
+        /** Compute all layers of the table with layer_engine<D, value_t>
+         * 
+         * Costs of the last layer are stored in table_. Quantized layers are stored in the cost 
+         * table of table_ and widened to cost_t in place after the last layer.
+         * 
+         * @param required Maximal required resistances (exactly D resistance types are non-zero unless D is 1)
+         * @param crafted Resistances each slot can keep at no cost or nullptr if slots are empty
+         * @param bounds Cells computed in each layer
+         * @param monitor Monitor of work done in each layer
+         */
+        template<std::size_t D, typename value_t>
+        void run_layers(
+            resistance required, 
+            const std::vector<resistance>* crafted, 
+            const layer_bounds& bounds, 
+            layer_monitor& monitor);
     };
 }
 
@@ -0,0 +1,162 @@
+#include "persistent_assignment.hpp"
+#include "table_file.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+#include <limits>
+
+recap::persistent_assignment::persistent_assignment(
+    std::unique_ptr<assignment_algorithm> algorithm, 
+    std::string directory, 
+    table_store_mode mode) :
+    algorithm_(std::move(algorithm)),
+    name_(std::string{ "persistent-" } + algorithm_->name()),
+    directory_(std::move(directory)),
+    mode_(mode)
+{
+}
+
+const char* recap::persistent_assignment::name() const
+{
+    return name_.c_str();
+}
+
+recap::cost_precision recap::persistent_assignment::precision() const
+{
+    return algorithm_->precision();
+}
+
+void recap::persistent_assignment::initialize(resistance max_res, std::size_t max_recipes)
+{
+    algorithm_->initialize(max_res, max_recipes);
+}
+
+bool recap::persistent_assignment::load_table(
+    resistance max_resistances, 
+    const std::vector<recipe::slot_t>& sorted_slots, 
+    const std::vector<recipe>& recipes)
+{
+    namespace fs = std::filesystem;
+
+    std::error_code error;
+    if (!fs::is_directory(directory_, error))
+    {
+        return false;
+    }
+
+    auto recipes_hash = hash_recipes(recipes);
+    auto slots_hash = hash_slots(sorted_slots);
+    auto precision = algorithm_->precision();
+
+    // find candidate files ordered by size
+    std::vector<std::pair<std::size_t, fs::path>> candidates;
+    for (auto& item : fs::directory_iterator{ directory_, error })
+    {
+        std::uint64_t file_recipes_hash, file_slots_hash;
+        resistance file_max_res;
+        cost_precision file_precision;
+        if (parse_table_file_name(item.path().filename().string(), file_recipes_hash, file_slots_hash, file_max_res, file_precision) &&
+            file_precision == precision &&
+            file_recipes_hash == recipes_hash &&
+            file_slots_hash == slots_hash &&
+            max_resistances <= file_max_res)
+        {
+            candidates.emplace_back(count_values(file_max_res), item.path());
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+
+    for (auto& candidate : candidates)
+    {
+        solution_table table;
+        try 
+        {
+            if (!map_table_file(candidate.second.string(), recipes, precision, table))
+            {
+                continue;
+            }
+        }
+        catch (std::runtime_error&)
+        {
+            // the file might have been removed by another process
+            continue;
+        }
+
+        // check for hash collisions
+        auto table_sorted_slots = table.slots();
+        std::sort(table_sorted_slots.begin(), table_sorted_slots.end());
+        if (table_sorted_slots != sorted_slots)
+        {
+            continue;
+        }
+
+        table_ = std::move(table);
+        table_recipes_ = recipes;
+        table_sorted_slots_ = std::move(table_sorted_slots);
+        return true;
+    }
+    return false;
+}
+
+const recap::solution_table& recap::persistent_assignment::build_table(
+    resistance max_resistances,
+    const std::vector<recipe::slot_t>& slots,
+    const std::vector<recipe>& recipes)
+{
+    // slots are interchangeable so the order doesn't matter
+    auto sorted_slots = slots;
+    std::sort(sorted_slots.begin(), sorted_slots.end());
+
+    // reuse the last mapped table
+    if (table_.is_read_only() &&
+        table_.contains(max_resistances) &&
+        table_sorted_slots_ == sorted_slots &&
+        table_recipes_ == recipes)
+    {
+        ++stats_.hits;
+        ++solve_stats_.tables_reused;
+        return table_;
+    }
+
+    if (load_table(max_resistances, sorted_slots, recipes))
+    {
+        ++stats_.hits;
+        ++solve_stats_.tables_reused;
+        return table_;
+    }
+
+    ++stats_.misses;
+
+    const auto& table = algorithm_->build_table(max_resistances, slots, recipes);
+    collect_solve_stats(*algorithm_);
+
+    if (mode_ == table_store_mode::read_write)
+    {
+        namespace fs = std::filesystem;
+
+        std::error_code error;
+        fs::create_directories(directory_, error);
+        if (error)
+        {
+            throw std::runtime_error{ "Can't create directory " + directory_ + ": " + error.message() };
+        }
+
+        auto precision = algorithm_->precision();
+        auto name = table_file_name(hash_recipes(recipes), hash_slots(sorted_slots), table.max_resistances(), precision);
+        write_table_file((fs::path{ directory_ } / name).string(), table, recipes, precision);
+    }
+    return table;
+}
+
+recap::assignment recap::persistent_assignment::find_minimal_recrafting(
+    resistance required,
+    const std::vector<recipe::slot_t>& slots,
+    const std::vector<resistance>& crafted,
+    const std::vector<recipe>& recipes)
+{
+    auto result = algorithm_->find_minimal_recrafting(required, slots, crafted, recipes);
+    collect_solve_stats(*algorithm_);
+    return result;
+}
\ No newline at end of file
@@ -0,0 +1,166 @@
+#ifndef RECAP_PERSISTENT_ASSIGNMENT_HPP_
+#define RECAP_PERSISTENT_ASSIGNMENT_HPP_
+
+#include <vector>
+#include <memory>
+#include <string>
+
+#include "recipe.hpp"
+#include "resistance.hpp"
+#include "assignment.hpp"
+#include "solution_table.hpp"
+#include "assignment_algorithm.hpp"
+#include "caching_assignment.hpp"
+
+namespace recap
+{
+    /** How the persistent table cache uses its directory
+     */
+    enum class table_store_mode
+    {
+        // only load tables which already exist
+        read_only,
+        // load existing tables and store newly computed tables
+        read_write
+    };
+
+    /** Decorator which stores solved tables of another algorithm in a directory.
+     * 
+     * Each table is stored in a versioned binary file identified by the hash of recipes,
+     * the multiset of slots, the dimensions of the table and the precision of its costs 
+     * (see table_file.hpp). Only tables with the precision() of the decorated algorithm 
+     * are loaded, so rounded costs are never used by an exact algorithm. Stored 
+     * tables are memory mapped read-only so a new process can answer a query without 
+     * running the dynamic programming algorithm and without copying the table. 
+     * Multiple processes can share the same directory.
+     */
+    class persistent_assignment : public assignment_algorithm
+    {
+    public:
+        /** Create a persistent cache for tables computed by @p algorithm
+         * 
+         * @param algorithm Algorithm which computes the tables
+         * @param directory Directory with table files (created on the first write)
+         * @param mode Whether newly computed tables are stored in @p directory
+         */
+        persistent_assignment(
+            std::unique_ptr<assignment_algorithm> algorithm, 
+            std::string directory, 
+            table_store_mode mode);
+
+        virtual ~persistent_assignment() {}
+
+        // Non-copyable
+        persistent_assignment(const persistent_assignment&) = delete;
+        persistent_assignment& operator=(const persistent_assignment&) = delete;
+
+        // Movable
+        persistent_assignment(persistent_assignment&&) = default;
+        persistent_assignment& operator=(persistent_assignment&&) = default;
+
+        /** Identifier of this algorithms
+         * 
+         * @returns name of this algorithm
+         */
+        const char* name() const override;
+
+        /** How costs of tables computed by the decorated algorithm are represented
+         * 
+         * @returns precision of the decorated algorithm
+         */
+        cost_precision precision() const override;
+
+        /** Allocate memory for problem instances
+         * 
+         * @param max_resistances Maximal number of resistances
+         * @param max_recipes Maximal number of recipes
+         */
+        void initialize(resistance max_resistances, std::size_t max_recipes) override;
+
+        /** Map a stored table which contains @p max_resistances or compute a new table.
+         * 
+         * In the read_write mode, the new table is stored in the directory.
+         * The table can be computed for a different order of @p slots (see solution_table::slots()).
+         * 
+         * @param max_resistances Maximal required resistances
+         * @param slots Free equipment slots where we can apply recipes
+         * @param recipes Available recipes
+         * 
+         * @return table with solutions (valid until the next call of this algorithm)
+         * 
+         * @throws std::runtime_error if a new table can't be stored
+         */
+        const solution_table& build_table(
+            resistance max_resistances, 
+            const std::vector<recipe::slot_t>& slots, 
+            const std::vector<recipe>& recipes) override;
+
+        /** Tables with crafted resistances are not stored, the call is forwarded to the decorated algorithm.
+         * 
+         * @param required Required resistances (including resistances crafted on the items)
+         * @param slots Equipment slots where we can apply recipes
+         * @param crafted Resistances currently crafted in each slot of @p slots
+         * @param recipes Available recipes
+         * 
+         * @return assignment of recipes to recrafted slots or invalid assingment object if assignment is not possible.
+         */
+        assignment find_minimal_recrafting(
+            resistance required, 
+            const std::vector<recipe::slot_t>& slots, 
+            const std::vector<resistance>& crafted, 
+            const std::vector<recipe>& recipes) override;
+
+        /** Number of queries answered from stored tables (hits) and computed tables (misses)
+         * 
+         * @returns counters since the creation of this object
+         */
+        inline const cache_statistics& cache_stats() const 
+        {
+            return stats_;
+        }
+
+        /** Directory with table files
+         * 
+         * @returns path to the directory
+         */
+        inline const std::string& directory() const 
+        {
+            return directory_;
+        }
+
+        /** Whether newly computed tables are stored
+         * 
+         * @returns mode of this cache
+         */
+        inline table_store_mode mode() const 
+        {
+            return mode_;
+        }
+
+    private:
+        std::unique_ptr<assignment_algorithm> algorithm_;
+        std::string name_;
+        std::string directory_;
+        table_store_mode mode_;
+        cache_statistics stats_;
+        // the last mapped table and the problem it solves
+        solution_table table_;
+        std::vector<recipe> table_recipes_;
+        std::vector<recipe::slot_t> table_sorted_slots_;
+
+        /** Find the smallest stored table which contains @p max_resistances and map it to table_
+         * 
+         * @param max_resistances Maximal required resistances
+         * @param sorted_slots Sorted list of slots
+         * @param recipes Available recipes
+         * 
+         * @returns true iff a table has been found
+         */
+        bool load_table(
+            resistance max_resistances, 
+            const std::vector<recipe::slot_t>& sorted_slots, 
+            const std::vector<recipe>& recipes);
+    };
+}
+
+#endif // RECAP_PERSISTENT_ASSIGNMENT_HPP_
\ No newline at end of file
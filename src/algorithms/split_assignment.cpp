@@ -0,0 +1,169 @@
+#include "split_assignment.hpp"
+#include "parallel_assignment.hpp"
+
+#include <algorithm>
+
+#include <tbb/parallel_invoke.h>
+
+recap::split_assignment::split_assignment() : 
+    split_assignment(std::make_unique<parallel_assignment>(), std::make_unique<parallel_assignment>())
+{
+}
+
+recap::split_assignment::split_assignment(
+    std::unique_ptr<assignment_algorithm> armour_algorithm, 
+    std::unique_ptr<assignment_algorithm> jewelry_algorithm) :
+    armour_algorithm_(std::move(armour_algorithm)),
+    jewelry_algorithm_(std::move(jewelry_algorithm))
+{
+}
+
+const char* recap::split_assignment::name() const
+{
+    return "split";
+}
+
+recap::cost_precision recap::split_assignment::precision() const
+{
+    return armour_algorithm_->precision();
+}
+
+void recap::split_assignment::initialize(resistance max_res, std::size_t max_recipes)
+{
+    armour_algorithm_->initialize(max_res, max_recipes);
+    jewelry_algorithm_->initialize(max_res, max_recipes);
+}
+
+const recap::solution_table& recap::split_assignment::build_table(
+    resistance max_resistances, 
+    const std::vector<recipe::slot_t>& slots, 
+    const std::vector<recipe>& recipes)
+{
+    const auto& table = armour_algorithm_->build_table(max_resistances, slots, recipes);
+    collect_solve_stats(*armour_algorithm_);
+    return table;
+}
+
+std::pair<const recap::solution_table*, const recap::solution_table*> recap::split_assignment::build_group_tables(
+    resistance max_resistances, 
+    const std::vector<recipe::slot_t>& slots, 
+    const std::vector<recipe>& recipes)
+{
+    std::vector<recipe::slot_t> armour_slots;
+    std::vector<recipe::slot_t> jewelry_slots;
+    for (auto slot : slots)
+    {
+        if ((slot & recipe::SLOT_JEWELRY) == 0)
+        {
+            armour_slots.push_back(slot);
+        }
+        else 
+        {
+            jewelry_slots.push_back(slot);
+        }
+    }
+
+    const solution_table* armour = nullptr;
+    const solution_table* jewelry = nullptr;
+    tbb::parallel_invoke(
+        [&]() { armour = &armour_algorithm_->build_table(max_resistances, armour_slots, recipes); },
+        [&]() { jewelry = &jewelry_algorithm_->build_table(max_resistances, jewelry_slots, recipes); });
+
+    // armour tables are numbered before jewelry tables
+    collect_solve_stats(*armour_algorithm_);
+    collect_solve_stats(*jewelry_algorithm_);
+    return { armour, jewelry };
+}
+
+recap::assignment recap::split_assignment::combine(
+    const solution_table& armour, 
+    const solution_table& jewelry, 
+    resistance required, 
+    const std::vector<recipe>& recipes)
+{
+    assert(armour.contains(required));
+    assert(jewelry.contains(required));
+
+    auto armour_costs = armour.costs();
+    auto jewelry_costs = jewelry.costs();
+
+    // find the best way to split required resistances between the groups
+    auto best_cost = recipe::MAX_COST;
+    auto best_split = resistance::make_zero();
+    for (resistance::item_t fire = 0; fire <= required.fire(); ++fire)
+    {
+        for (resistance::item_t cold = 0; cold <= required.cold(); ++cold)
+        {
+            for (resistance::item_t lightning = 0; lightning <= required.lightning(); ++lightning)
+            {
+                // chaos resistances are contiguous in both rows (in the opposite order)
+                resistance row{ fire, cold, lightning, 0 };
+                auto armour_row = armour_costs + armour.to_index(row);
+                auto jewelry_row = jewelry_costs + jewelry.to_index(required - row);
+                for (resistance::item_t chaos = 0; chaos <= required.chaos(); ++chaos)
+                {
+                    auto cost = armour_row[chaos] + jewelry_row[-static_cast<std::ptrdiff_t>(chaos)];
+                    if (cost < best_cost)
+                    {
+                        best_cost = cost;
+                        best_split = resistance{ fire, cold, lightning, chaos };
+                    }
+                }
+            }
+        }
+    }
+
+    assignment result;
+    if (best_cost == recipe::MAX_COST)
+    {
+        return result;
+    }
+
+    auto armour_result = armour.find_assignment(best_split, recipes);
+    auto jewelry_result = jewelry.find_assignment(required - best_split, recipes);
+
+    result.cost() = best_cost;
+    result.assignments() = std::move(armour_result.assignments());
+    result.assignments().insert(
+        result.assignments().end(), 
+        jewelry_result.assignments().begin(), 
+        jewelry_result.assignments().end());
+    return result;
+}
+
+recap::assignment recap::split_assignment::find_minimal_assignment(
+    resistance required, 
+    const std::vector<recipe::slot_t>& slots, 
+    const std::vector<recipe>& recipes)
+{
+    auto tables = build_group_tables(required, slots, recipes);
+    return combine(*tables.first, *tables.second, required, recipes);
+}
+
+std::vector<recap::assignment> recap::split_assignment::find_minimal_assignments(
+    const std::vector<resistance>& required, 
+    const std::vector<recipe::slot_t>& slots, 
+    const std::vector<recipe>& recipes)
+{
+    // find component-wise maximum of all requirements
+    resistance max_resistances = resistance::make_zero();
+    for (auto& req : required)
+    {
+        max_resistances = resistance{
+            std::max(max_resistances.fire(), req.fire()),
+            std::max(max_resistances.cold(), req.cold()),
+            std::max(max_resistances.lightning(), req.lightning()),
+            std::max(max_resistances.chaos(), req.chaos())
+        };
+    }
+
+    auto tables = build_group_tables(max_resistances, slots, recipes);
+
+    std::vector<assignment> result;
+    result.reserve(required.size());
+    for (auto& req : required)
+    {
+        result.push_back(combine(*tables.first, *tables.second, req, recipes));
+    }
+    return result;
+}
\ No newline at end of file
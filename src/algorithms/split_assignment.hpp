@@ -0,0 +1,152 @@
+#ifndef RECAP_SPLIT_ASSIGNMENT_HPP_
+#define RECAP_SPLIT_ASSIGNMENT_HPP_
+
+#include <vector>
+#include <memory>
+#include <utility>
+
+#include "recipe.hpp"
+#include "resistance.hpp"
+#include "assignment.hpp"
+#include "solution_table.hpp"
+#include "assignment_algorithm.hpp"
+
+namespace recap
+{
+    /** Meet-in-the-middle algorithm which solves armour and jewelry slots separately.
+     * 
+     * Each group of slots gets its own table computed by its own algorithm (the tables 
+     * are computed concurrently and each algorithm can cache its tables independently). 
+     * Tables are only combined at the required cell: 
+     * 
+     *     cost(required) = min { armour[r] + jewelry[required - r] | r <= required }
+     * 
+     * which is a single scan over the table. If only one group of slots changes, only 
+     * its table has to be recomputed.
+     */
+    class split_assignment : public assignment_algorithm
+    {
+    public:
+        /** Create the algorithm with the default algorithm for each group
+         */
+        split_assignment();
+
+        /** Solve each group of slots with a different algorithm
+         * 
+         * @param armour_algorithm Algorithm for slots which don't accept jewelry recipes
+         * @param jewelry_algorithm Algorithm for the other slots
+         */
+        split_assignment(
+            std::unique_ptr<assignment_algorithm> armour_algorithm, 
+            std::unique_ptr<assignment_algorithm> jewelry_algorithm);
+
+        virtual ~split_assignment() {}
+
+        // Non-copyable
+        split_assignment(const split_assignment&) = delete;
+        split_assignment& operator=(const split_assignment&) = delete;
+
+        // Movable
+        split_assignment(split_assignment&&) = default;
+        split_assignment& operator=(split_assignment&&) = default;
+
+        /** Identifier of this algorithms
+         * 
+         * @returns name of this algorithm
+         */
+        const char* name() const override;
+
+        /** How costs of tables computed by this algorithm are represented
+         * 
+         * @returns precision of the armour algorithm (it computes tables of all slots)
+         */
+        cost_precision precision() const override;
+
+        /** Allocate memory for problem instances
+         * 
+         * @param max_resistances Maximal number of resistances
+         * @param max_recipes Maximal number of recipes
+         */
+        void initialize(resistance max_resistances, std::size_t max_recipes) override;
+
+        /** Compute a table for all slots.
+         * 
+         * The combined table is never materialized by this algorithm (it would need a full 
+         * min-plus convolution of the group tables). The table is computed by the armour 
+         * algorithm using all slots instead.
+         * 
+         * @param max_resistances Maximal required resistances
+         * @param slots Free equipment slots where we can apply recipes
+         * @param recipes Available recipes
+         * 
+         * @return table with solutions (valid until the next call of this algorithm)
+         */
+        const solution_table& build_table(
+            resistance max_resistances, 
+            const std::vector<recipe::slot_t>& slots, 
+            const std::vector<recipe>& recipes) override;
+
+        /** Find assignment of @p recipes to equipment @p slots which minimizes cost and 
+         * has at least @p required resistances.
+         * 
+         * @param required Required resistances 
+         * @param slots Free equipment slots where we can apply recipes
+         * @param recipes Available recipes
+         * 
+         * @return assignment of recipes to slots or invalid assingment object if assignment is not possible.
+         */
+        assignment find_minimal_assignment(
+            resistance required, 
+            const std::vector<recipe::slot_t>& slots, 
+            const std::vector<recipe>& recipes) override;
+
+        /** Find minimal cost assignment for each requirement in @p required.
+         * 
+         * Group tables are only built once for the component-wise maximum of all requirements.
+         * 
+         * @param required List of required resistances
+         * @param slots Free equipment slots where we can apply recipes
+         * @param recipes Available recipes
+         * 
+         * @return assignment for each requirement in @p required (in the same order)
+         */
+        std::vector<assignment> find_minimal_assignments(
+            const std::vector<resistance>& required, 
+            const std::vector<recipe::slot_t>& slots, 
+            const std::vector<recipe>& recipes) override;
+
+    private:
+        std::unique_ptr<assignment_algorithm> armour_algorithm_;
+        std::unique_ptr<assignment_algorithm> jewelry_algorithm_;
+
+        /** Compute tables of both groups of slots concurrently
+         * 
+         * @param max_resistances Maximal required resistances
+         * @param slots Free equipment slots where we can apply recipes
+         * @param recipes Available recipes
+         * 
+         * @returns armour and jewelry table (valid until the next call of this algorithm)
+         */
+        std::pair<const solution_table*, const solution_table*> build_group_tables(
+            resistance max_resistances, 
+            const std::vector<recipe::slot_t>& slots, 
+            const std::vector<recipe>& recipes);
+
+        /** Combine group tables at the @p required cell
+         * 
+         * @param armour Table of the armour slots
+         * @param jewelry Table of the jewelry slots
+         * @param required Required resistances (contained in both tables)
+         * @param recipes Recipes used to compute the tables
+         * 
+         * @return assignment of recipes to slots or invalid assingment object if assignment is not possible.
+         */
+        static assignment combine(
+            const solution_table& armour, 
+            const solution_table& jewelry, 
+            resistance required, 
+            const std::vector<recipe>& recipes);
+    };
+}
+
+#endif // RECAP_SPLIT_ASSIGNMENT_HPP_
\ No newline at end of file
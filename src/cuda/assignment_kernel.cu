@@ -52,11 +52,19 @@ __device__ int vector_to_index(index_vector_t indices, index_vector_t table_dim)
  */
 __device__ index_vector_t index_vector_sub(index_vector_t lhs, index_vector_t rhs)
 {
+    // saturating subtraction of two pairs of 16-bit values packed in 32-bit words
+    auto first = __vsubus2(
+        lhs.x | static_cast<unsigned>(lhs.y) << 16, 
+        rhs.x | static_cast<unsigned>(rhs.y) << 16);
+    auto second = __vsubus2(
+        lhs.z | static_cast<unsigned>(lhs.w) << 16, 
+        rhs.z | static_cast<unsigned>(rhs.w) << 16);
+
     index_vector_t result;
-    result.x = max(lhs.x - (int)rhs.x, 0);
-    result.y = max(lhs.y - (int)rhs.y, 0);
-    result.z = max(lhs.z - (int)rhs.z, 0);
-    result.w = max(lhs.w - (int)rhs.w, 0);
+    result.x = static_cast<recap::cuda::resistance_t>(first);
+    result.y = static_cast<recap::cuda::resistance_t>(first >> 16);
+    result.z = static_cast<recap::cuda::resistance_t>(second);
+    result.w = static_cast<recap::cuda::resistance_t>(second >> 16);
     return result;
 }
 
@@ -69,7 +77,6 @@ __global__ void assignment_kernel(
     const recap::cuda::input_data input, 
     recap::cuda::output_data output)
 {
-    constexpr std::size_t MAX_SLOT_COUNT = recap::cuda::MAX_SLOT_COUNT;
     constexpr recap::recipe::cost_t MAX_COST = INFINITY;
 
     auto current_index = blockIdx.x * blockDim.x + threadIdx.x;
@@ -81,19 +88,17 @@ __global__ void assignment_kernel(
     // find resistances at current index
     auto current_resist = index_to_vector(current_index, input.table_dim);
     auto best_cost = MAX_COST;
-    auto best_index = current_index;
     auto best_recipe_index = 0;
 
     for (int i = 0; i < input.recipes.count; ++i)
     {
         auto recipe_cost = input.recipes.costs[i];
-        auto recipe_resist = input.recipes.resistances[i];
-        auto recipe_slots = input.recipes.slots[i];
-
-        if ((input.slot & recipe_slots) == 0)
-        {
-            continue;
-        }
+        index_vector_t recipe_resist{ 
+            input.recipes.fire[i], 
+            input.recipes.cold[i], 
+            input.recipes.lightning[i], 
+            input.recipes.chaos[i] 
+        };
 
         // find resistances if we use assigned recipe
         auto prev_resist = index_vector_sub(current_resist, recipe_resist);
@@ -104,21 +109,15 @@ __global__ void assignment_kernel(
         if (best_cost > prev_cost + recipe_cost)
         {
             best_cost = prev_cost + recipe_cost;
-            best_index = prev_index;
-            best_recipe_index = i;
+            best_recipe_index = input.recipes.indices[i];
         }
     }
 
     // set best cost of this table cell
     output.best_cost[current_index] = best_cost;
 
-    // set best assignment for this cell
-    memcpy(
-        output.best_assignment + current_index * MAX_SLOT_COUNT,
-        input.best_assignment + best_index * MAX_SLOT_COUNT,
-        MAX_SLOT_COUNT
-    );
-    output.best_assignment[current_index * MAX_SLOT_COUNT + input.slot_index] = best_recipe_index;
+    // set recipe used in this cell (the assignment is reconstructed on the host)
+    output.best_recipe[current_index] = best_recipe_index;
 }
 
 void recap::cuda::run_assignment_kernel(const input_data input, output_data output)
@@ -26,12 +26,15 @@ namespace recap
 
         struct recipes_data
         {
-            // Resistances of provided by recipes
-            const vector4<resistance_t>* resistances;
+            // Resistances provided by recipes (one array for each type of resistance)
+            const resistance_t* fire;
+            const resistance_t* cold;
+            const resistance_t* lightning;
+            const resistance_t* chaos;
             // Cost of recipes
             const recipe::cost_t* costs;
-            // Recipe slots
-            const recipe::slot_t* slots;
+            // Index of recipes in the list of all recipes
+            const std::uint8_t* indices;
             // Number of recipes
             std::uint32_t count;
         };
@@ -40,26 +43,20 @@ namespace recap
         {
             // Array of best costs from previous iteration
             const float* best_cost;
-            // Best assignments (indices of recipes) from previous iteration
-            const std::uint8_t* best_assignment;
             // Table size 
             std::uint32_t table_size;
             // Maximal resistances
             vector4<resistance_t> table_dim;
-            // Available recipes
+            // Recipes aplicable to the current slot
             recipes_data recipes;
-            // Current slot mask
-            recipe::slot_t slot;
-            // index of a slot
-            std::uint8_t slot_index;
         };
 
         struct output_data
         {
             // Array of best costs in this iteration 
             float* best_cost;
-            // Best assignemnts (indices of recipes) in this iteration
-            std::uint8_t* best_assignment;
+            // Recipe used in each table cell in this iteration
+            std::uint8_t* best_recipe;
         };
 
         void run_assignment_kernel(const input_data input, output_data output);
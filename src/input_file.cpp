@@ -0,0 +1,154 @@
+#include "input_file.hpp"
+#include "trace.hpp"
+
+std::vector<recap::recipe> recap::read_recipes(const std::string& path)
+{
+    trace::span span{ "read recipes", "input" };
+
+    // read file header
+    io::CSVReader<8> input(path);
+    input.read_header(io::ignore_extra_column, "fire", "cold", "lightning", "chaos", "value_min", "value_max", "cost", "slot");
+
+    // add a null recipe to index 0
+    std::vector<recipe> result;
+    result.push_back(recipe{ resistance{ 0, 0, 0, 0 }, 0, recipe::SLOT_ALL });
+
+    // read recipes from file
+    resistance::item_t fire, cold, lightning, chaos, value_min, value_max;
+    recipe::cost_t cost = 0;
+    std::string slot_name;
+    while (input.read_row(fire, cold, lightning, chaos, value_min, value_max, cost, slot_name))
+    {
+        if (fire > 1)
+        {
+            throw invalid_input_error{ 
+                input.get_file_line(), 
+                "fire value has to be 0 or 1." };
+        }
+
+        if (cold > 1)
+        {
+            throw invalid_input_error{ 
+                input.get_file_line(), 
+                "cold value has to be 0 or 1." };
+        }
+
+        if (lightning > 1)
+        {
+            throw invalid_input_error{ 
+                input.get_file_line(), 
+                "lightning value has to be 0 or 1." };
+        }
+
+        if (chaos > 1)
+        {
+            throw invalid_input_error{ 
+                input.get_file_line(), 
+                "chaos value has to be 0 or 1." };
+        }
+
+        if (value_min > value_max)
+        {
+            throw invalid_input_error{ 
+                input.get_file_line(), 
+                "minimal value must not be greater than maximal value." };
+        }
+
+        recipe::slot_t slot_value = parse_slot(slot_name);
+        if (slot_value == recipe::SLOT_NONE)
+        {
+            throw invalid_input_error{ 
+                input.get_file_line(), 
+                "invalid slot: " + slot_name };
+        }
+
+        // generate recipes
+        for (resistance::item_t i = value_min; i <= value_max; ++i)
+        {
+            // compute expected cost of rolling these values
+            double instance_cost = cost * (value_max - value_min + 1.0) / (value_max - i + 1.0);
+            result.push_back(recipe{
+                resistance{
+                    static_cast<resistance::item_t>(fire * i),
+                    static_cast<resistance::item_t>(cold * i),
+                    static_cast<resistance::item_t>(lightning * i),
+                    static_cast<resistance::item_t>(chaos * i)
+                }, 
+                static_cast<recipe::cost_t>(instance_cost),
+                slot_value
+            });
+        }
+    }
+
+    return result;
+}
+
+std::vector<recap::equipment> recap::read_equipment(const std::string& path)
+{
+    trace::span span{ "read equipment", "input" };
+
+    std::vector<equipment> items;
+
+    // read file header
+    io::CSVReader<11> input(path);
+    input.read_header(io::ignore_extra_column, 
+        "slot", 
+        "craft_fire", 
+        "craft_cold", 
+        "craft_lightning", 
+        "craft_chaos", 
+        "base_fire", 
+        "base_cold", 
+        "base_lightning", 
+        "base_chaos", 
+        "is_craftable", 
+        "is_new");
+
+    // read values from file
+    resistance::item_t craft_fire = 0, craft_cold = 0, craft_lightning = 0, craft_chaos = 0;
+    resistance::item_t base_fire = 0, base_cold = 0, base_lightning = 0, base_chaos = 0;
+    int is_craftable, is_new;
+    std::string slot_name;
+    while (input.read_row(slot_name, 
+        craft_fire, craft_cold, craft_lightning, craft_chaos, 
+        base_fire, base_cold, base_lightning, base_chaos,
+        is_craftable, is_new))
+    {
+        auto slot_value = parse_slot(slot_name);
+        if (slot_value == recipe::SLOT_NONE) 
+        {
+            throw invalid_input_error{
+                input.get_file_line(),
+                "Invalid slot name: " + slot_name
+            };
+        }
+
+        items.push_back(equipment{ slot_value, 
+            resistance{ craft_fire, craft_cold, craft_lightning, craft_chaos },
+            resistance{ base_fire, base_cold, base_lightning, base_chaos }, 
+            !!is_craftable,
+            !!is_new });
+    }
+
+    return items;
+}
+
+std::vector<recap::resistance> recap::read_requirements(const std::string& path)
+{
+    trace::span span{ "read requirements", "input" };
+
+    std::vector<resistance> requirements;
+
+    // read file header
+    io::CSVReader<4> input(path);
+    input.read_header(io::ignore_extra_column, "fire", "cold", "lightning", "chaos");
+
+    // read values from file
+    resistance::item_t fire = 0, cold = 0, lightning = 0, chaos = 0;
+    while (input.read_row(fire, cold, lightning, chaos))
+    {
+        requirements.push_back(resistance{ fire, cold, lightning, chaos });
+    }
+
+    return requirements;
+}
@@ -0,0 +1,57 @@
+#ifndef RECAP_INPUT_FILE_HPP_
+#define RECAP_INPUT_FILE_HPP_
+
+#include <string>
+#include <vector>
+#include <exception>
+
+#include <csv.h>
+
+#include "resistance.hpp"
+#include "recipe.hpp"
+#include "equipment.hpp"
+
+namespace recap
+{
+    /** Exception thrown if values in an input file are invalid
+     */
+    class invalid_input_error : public std::exception
+    {
+    public:
+        invalid_input_error(std::size_t line_num, const std::string& msg) :
+            msg_("Error on line " + std::to_string(line_num) + ": " + msg) {}
+
+        const char* what() const noexcept override 
+        {
+            return msg_.c_str();
+        }
+    private:
+        std::string msg_;
+    };
+
+    /** Read recipes from a CSV file located at @p path
+     * 
+     * @param path Path to a file with recipes
+     * 
+     * @returns list of recipes
+     */
+    std::vector<recipe> read_recipes(const std::string& path);
+
+    /** Read equipment from @p path
+     * 
+     * @param path Path to a file
+     * 
+     * @returns equipment items
+     */
+    std::vector<equipment> read_equipment(const std::string& path);
+
+    /** Read required resistances from a CSV file located at @p path
+     * 
+     * @param path Path to a file with one requirement per row
+     * 
+     * @returns list of required resistances
+     */
+    std::vector<resistance> read_requirements(const std::string& path);
+}
+
+#endif // RECAP_INPUT_FILE_HPP_
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <fstream>
 #include <string>
 #include <vector>
 #include <iomanip>
@@ -6,7 +7,6 @@
 #include <chrono>
 #include <memory>
 
-#include <csv.h>
 #include <rang.hpp>
 #include <boost/program_options.hpp>
 
@@ -14,23 +14,13 @@
 #include "recipe.hpp"
 #include "assignment.hpp"
 #include "equipment.hpp"
+#include "input_file.hpp"
 #include "cuda_assignment.hpp"
 #include "parallel_assignment.hpp"
-
-// exception thrown if input values are invalid
-class invalid_input_error : public std::exception
-{
-public:
-    invalid_input_error(std::size_t line_num, const std::string& msg) :
-        msg_("Error on line " + std::to_string(line_num) + ": " + msg) {}
-
-    const char* what() const noexcept override 
-    {
-        return msg_.c_str();
-    }
-private:
-    std::string msg_;
-};
+#include "persistent_assignment.hpp"
+#include "split_assignment.hpp"
+#include "gather_assignment.hpp"
+#include "trace.hpp"
 
 class invalid_arg_error : public std::exception
 {
@@ -46,148 +36,18 @@ private:
     std::string msg_;
 };
 
-/** Read recipes from a CSV file located at @p path
- * 
- * @param path Path to a file with recipes
- * 
- * @returns list of recipes
- */
-std::vector<recap::recipe> read_recipes(const std::string& path)
-{
-    using namespace recap;
-
-    // read file header
-    io::CSVReader<8> input(path);
-    input.read_header(io::ignore_extra_column, "fire", "cold", "lightning", "chaos", "value_min", "value_max", "cost", "slot");
-
-    // add a null recipe to index 0
-    std::vector<recipe> result;
-    result.push_back(recipe{ resistance{ 0, 0, 0, 0 }, 0, recipe::SLOT_ALL });
-
-    // read recipes from file
-    resistance::item_t fire, cold, lightning, chaos, value_min, value_max;
-    recipe::cost_t cost = 0;
-    std::string slot_name;
-    while (input.read_row(fire, cold, lightning, chaos, value_min, value_max, cost, slot_name))
-    {
-        if (fire > 1)
-        {
-            throw invalid_input_error{ 
-                input.get_file_line(), 
-                "fire value has to be 0 or 1." };
-        }
-
-        if (cold > 1)
-        {
-            throw invalid_input_error{ 
-                input.get_file_line(), 
-                "cold value has to be 0 or 1." };
-        }
-
-        if (lightning > 1)
-        {
-            throw invalid_input_error{ 
-                input.get_file_line(), 
-                "lightning value has to be 0 or 1." };
-        }
-
-        if (chaos > 1)
-        {
-            throw invalid_input_error{ 
-                input.get_file_line(), 
-                "chaos value has to be 0 or 1." };
-        }
-
-        if (value_min > value_max)
-        {
-            throw invalid_input_error{ 
-                input.get_file_line(), 
-                "minimal value must not be greater than maximal value." };
-        }
-
-        recipe::slot_t slot_value = parse_slot(slot_name);
-        if (slot_value == recipe::SLOT_NONE)
-        {
-            throw invalid_input_error{ 
-                input.get_file_line(), 
-                "invalid slot: " + slot_name };
-        }
-
-        // generate recipes
-        for (resistance::item_t i = value_min; i <= value_max; ++i)
-        {
-            // compute expected cost of rolling these values
-            double instance_cost = cost * (value_max - value_min + 1.0) / (value_max - i + 1.0);
-            result.push_back(recipe{
-                resistance{
-                    static_cast<resistance::item_t>(fire * i),
-                    static_cast<resistance::item_t>(cold * i),
-                    static_cast<resistance::item_t>(lightning * i),
-                    static_cast<resistance::item_t>(chaos * i)
-                }, 
-                static_cast<recipe::cost_t>(instance_cost),
-                slot_value
-            });
-        }
-    }
-
-    return result;
-}
-
-/** Read equipment from @p path
- * 
- * @param path Path to a file
+/** Print @p required resistances
  * 
- * @returns equipment items
- */
-std::vector<recap::equipment> read_equipment(const std::string& path)
+ * @param output Output stream
+ * @param required Required resistances
+ */ 
+void print_required(std::ostream& output, const recap::resistance& required)
 {
-    using namespace recap;
-
-    std::vector<equipment> items;
-
-    // read file header
-    io::CSVReader<11> input(path);
-    input.read_header(io::ignore_extra_column, 
-        "slot", 
-        "craft_fire", 
-        "craft_cold", 
-        "craft_lightning", 
-        "craft_chaos", 
-        "base_fire", 
-        "base_cold", 
-        "base_lightning", 
-        "base_chaos", 
-        "is_craftable", 
-        "is_new");
-
-    // read values from file
-    resistance::item_t craft_fire = 0, craft_cold = 0, craft_lightning = 0, craft_chaos = 0;
-    resistance::item_t base_fire = 0, base_cold = 0, base_lightning = 0, base_chaos = 0;
-    int is_craftable, is_new;
-    std::string slot_name;
-    while (input.read_row(slot_name, 
-        craft_fire, craft_cold, craft_lightning, craft_chaos, 
-        base_fire, base_cold, base_lightning, base_chaos,
-        is_craftable, is_new))
-    {
-        auto slot_value = parse_slot(slot_name);
-        if (slot_value == recipe::SLOT_NONE) 
-        {
-            throw invalid_input_error{
-                input.get_file_line(),
-                "Invalid slot name: " + slot_name
-            };
-        }
-
-        items.push_back(equipment{ slot_value, 
-            resistance{ craft_fire, craft_cold, craft_lightning, craft_chaos },
-            resistance{ base_fire, base_cold, base_lightning, base_chaos }, 
-            !!is_craftable,
-            !!is_new });
-    }
-
-    return items;
+    output << "Required: " 
+        << required.fire() << "% fire, "
+        << required.cold() << "% cold, "
+        << required.lightning() << "% lightning, "
+        << required.chaos() << "% chaos " << std::endl;
 }
 
 /** Print @p assign in a human readable way
@@ -322,6 +182,8 @@ int main(int argc, char** argv)
     algorithms.emplace_back(std::make_unique<cuda_assignment>());
 #endif // USE_CUDA
     algorithms.emplace_back(std::make_unique<parallel_assignment>());
+    algorithms.emplace_back(std::make_unique<split_assignment>());
+    algorithms.emplace_back(std::make_unique<gather_assignment>());
 
     // find names of available algorithms
     std::string available_algorithms = "";
@@ -339,9 +201,20 @@ int main(int argc, char** argv)
         ("help,h", "show help message")
         ("input,i", po::value<std::string>(), "path to a file with all available recipes")
         ("equip,e", po::value<std::string>(), "path to a file with all your equipment")
-        ("with,w", po::value<std::string>()->default_value("parallel"), "used assignment algorithm (available: parallel, cuda)")
+        ("batch,b", po::value<std::string>(), "path to a file with required resistances (one requirement per row)")
+        ("with,w", po::value<std::string>()->default_value("parallel"), "used assignment algorithm (available: parallel, split, gather, cuda)")
         ("armour,a", po::value<std::size_t>()->default_value(7), "number of armour slots")
         ("jewelery,j", po::value<std::size_t>()->default_value(3), "number of jewelery slots")
+        ("in-place", "update the table of the parallel algorithm in place (halves the memory used by costs)")
+        ("layout", po::value<std::string>(), "order of table cells of the parallel algorithm (available: dense, padded, tiled)")
+        ("quantized", "use 16-bit fixed-point costs in the parallel algorithm (the cost can exceed the minimum by the reported tolerance)")
+        ("cache-dir", po::value<std::string>(), "directory with solved tables (stored tables are loaded instead of recomputed)")
+        ("cache-mode", po::value<std::string>()->default_value("populate"), 
+            "how --cache-dir is used (populate: load and store tables, read-only: only load tables)")
+        ("stats", "print work done in each layer of the computed tables")
+        ("counters", "capture hardware counters in each layer of the parallel algorithm (printed with --stats and --stats-json)")
+        ("stats-json", po::value<std::string>(), "path to a file where statistics of the computation are written as JSON (- for standard output)")
+        ("trace", po::value<std::string>(), "path to a file where a timeline of the computation is written in the Chrome trace event format (open it in Perfetto)")
         ("required,r", po::value<std::vector<resistance::item_t>>()->multitoken(), 
             "list of required resistances (in order: fire, cold, lightning, and chaos")
         ("current,c", po::value<std::vector<resistance::item_t>>()->multitoken(), 
@@ -373,7 +246,7 @@ int main(int argc, char** argv)
     }
 
     // check that all required options are present
-    std::array<std::string, 2> required{ "input", "required" };
+    std::array<std::string, 1> required{ "input" };
     for (auto&& r : required)
     {
         if (!vm.count(r))
@@ -383,14 +256,27 @@ int main(int argc, char** argv)
         }
     }
 
+    // required resistances are either in arguments or in a file
+    if (!vm.count("required") && !vm.count("batch"))
+    {
+        std::cerr << "Error: argument --required or --batch is mandatory" << std::endl;
+        return 1;
+    }
+
+    if (vm.count("batch") && vm.count("equip"))
+    {
+        std::cerr << "Error: argument --batch can't be used with --equip" << std::endl;
+        return 1;
+    }
+
     // validate algorithm
     auto alg_name = vm["with"].as<std::string>();
-    assignment_algorithm* alg = nullptr;
+    std::unique_ptr<assignment_algorithm> alg;
     for (auto&& item : algorithms)
     {
         if (item->name() == alg_name)
         {
-            alg = item.get();
+            alg = std::move(item);
             break;
         }
     }
@@ -403,6 +289,165 @@ int main(int argc, char** argv)
         return 1;
     }
 
+    // keep only one cost table in memory
+    auto update = layer_update::double_buffer;
+    if (vm.count("in-place"))
+    {
+        if (alg_name != "parallel")
+        {
+            std::cerr << "Error: argument --in-place can only be used with the parallel algorithm" << std::endl;
+            return 1;
+        }
+
+        update = layer_update::in_place;
+    }
+
+    // order of cells in memory
+    auto layout = layout_kind::dense;
+    if (vm.count("layout"))
+    {
+        if (alg_name != "parallel")
+        {
+            std::cerr << "Error: argument --layout can only be used with the parallel algorithm" << std::endl;
+            return 1;
+        }
+
+        auto layout_name = vm["layout"].as<std::string>();
+        if (layout_name == "padded")
+        {
+            layout = layout_kind::padded;
+        }
+        else if (layout_name == "tiled")
+        {
+            layout = layout_kind::tiled;
+        }
+        else if (layout_name != "dense")
+        {
+            std::cerr 
+                << "Error: --layout '" << layout_name
+                << "' is invalid. Valid values are: dense, padded, tiled" << std::endl;
+            return 1;
+        }
+    }
+
+    // represent costs as fixed-point numbers
+    auto precision = cost_precision::exact;
+    if (vm.count("quantized"))
+    {
+        if (alg_name != "parallel")
+        {
+            std::cerr << "Error: argument --quantized can only be used with the parallel algorithm" << std::endl;
+            return 1;
+        }
+
+        precision = cost_precision::quantized;
+    }
+
+    // read hardware performance counters of each layer
+    auto counters = vm.count("counters") > 0;
+    if (counters && alg_name != "parallel")
+    {
+        std::cerr << "Error: argument --counters can only be used with the parallel algorithm" << std::endl;
+        return 1;
+    }
+
+    // algorithm which reports the cost tolerance of quantized costs
+    const parallel_assignment* quantized_alg = nullptr;
+    if (update != layer_update::double_buffer || layout != layout_kind::dense || precision != cost_precision::exact || counters)
+    {
+        auto parallel_alg = std::make_unique<parallel_assignment>(simd::detect_isa(), update, layout, precision);
+        parallel_alg->set_hardware_counters(counters);
+        if (precision == cost_precision::quantized)
+        {
+            quantized_alg = parallel_alg.get();
+        }
+        alg = std::move(parallel_alg);
+    }
+
+    // print how much the cost can exceed the minimal cost if costs have been rounded
+    auto print_tolerance = [&]()
+    {
+        if (quantized_alg != nullptr && quantized_alg->cost_tolerance() > 0)
+        {
+            std::cout << "Cost tolerance of quantized costs: " << quantized_alg->cost_tolerance() << std::endl;
+        }
+    };
+
+    // print statistics of all tables computed in the last solve
+    auto print_stats = [&]()
+    {
+        if (vm.count("stats"))
+        {
+            std::cout << std::endl;
+            print_statistics(std::cout, alg->solve_stats());
+        }
+
+        if (vm.count("stats-json"))
+        {
+            auto path = vm["stats-json"].as<std::string>();
+            if (path == "-")
+            {
+                write_statistics_json(std::cout, alg->solve_stats());
+                return;
+            }
+
+            std::ofstream output{ path };
+            if (!output)
+            {
+                throw std::runtime_error{ "Cannot write statistics to " + path };
+            }
+            write_statistics_json(output, alg->solve_stats());
+        }
+    };
+
+    // record spans from loading of the input to the end of the solve
+    if (vm.count("trace"))
+    {
+        trace::start();
+    }
+
+    // write the recorded timeline
+    auto write_trace = [&]()
+    {
+        if (!vm.count("trace"))
+        {
+            return;
+        }
+
+        trace::stop();
+        auto path = vm["trace"].as<std::string>();
+        std::ofstream output{ path };
+        if (!output)
+        {
+            throw std::runtime_error{ "Cannot write trace to " + path };
+        }
+        trace::write_json(output);
+    };
+
+    // load and store solved tables in a directory
+    if (vm.count("cache-dir"))
+    {
+        auto mode_name = vm["cache-mode"].as<std::string>();
+        table_store_mode mode;
+        if (mode_name == "populate")
+        {
+            mode = table_store_mode::read_write;
+        }
+        else if (mode_name == "read-only")
+        {
+            mode = table_store_mode::read_only;
+        }
+        else 
+        {
+            std::cerr 
+                << "Error: --cache-mode '" << mode_name 
+                << "' is invalid. Valid values are: populate, read-only" << std::endl;
+            return 1;
+        }
+
+        alg = std::make_unique<persistent_assignment>(std::move(alg), vm["cache-dir"].as<std::string>(), mode);
+    }
+
     // read recipes from file
     std::vector<recipe> recipes;
     try 
@@ -410,15 +455,16 @@ int main(int argc, char** argv)
         recipes = read_recipes(vm["input"].as<std::string>());
         std::cout << "Loaded " << recipes.size() << " recipe variants." << std::endl;
 
+        // these variants are never needed in an optimal assignment
+        auto removed_count = remove_dominated_recipes(recipes);
+        std::cout << "Removed " << removed_count << " dominated recipe variants." << std::endl;
+
         if (recipes.size() > MAX_RECIPE_COUNT)
         {
             std::cerr << "Error: this tool is limited to " << MAX_RECIPE_COUNT << " recipe variants at the moment." << std::endl;
             return 1;
         }
 
-        // read resistances
-        resistance required = read_resistance_arg("required", vm);
-
         // read slots
         auto armour_slot_cout = vm["armour"].as<std::size_t>();
         if (armour_slot_cout > MAX_ARMOUR_SLOT_COUNT)
@@ -445,12 +491,44 @@ int main(int argc, char** argv)
             slots.push_back(recipe::SLOT_JEWELRY);
         }
 
+        // answer all requirements from one table
+        if (vm.count("batch"))
+        {
+            auto requirements = read_requirements(vm["batch"].as<std::string>());
+
+            std::cout << "Using " << alg->name() <<  " algorithm ..." << std::endl;
+            std::cout 
+                << "Armour slots: " << armour_slot_cout << std::endl 
+                << "Jewelery slots: " << jewelry_slot_count << std::endl;
+
+            std::cout << std::endl;
+
+            auto begin = std::chrono::steady_clock::now();
+            auto results = alg->find_minimal_assignments(requirements, slots, recipes);
+            auto end = std::chrono::steady_clock::now();
+            if (trace::is_enabled())
+            {
+                trace::record("solve", "solve", begin, end, "requirements", static_cast<std::int64_t>(requirements.size()));
+            }
+            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count();
+
+            for (std::size_t i = 0; i < requirements.size(); ++i)
+            {
+                print_required(std::cout, requirements[i]);
+                print_assignment(std::cout, results[i]);
+            }
+            print_tolerance();
+            std::cout << duration << " ms" << std::endl;
+            print_stats();
+            write_trace();
+            return 0;
+        }
+
+        // read resistances
+        resistance required = read_resistance_arg("required", vm);
+
         // Print required resistances
-        std::cout << "Required: " 
-            << required.fire() << "% fire, "
-            << required.cold() << "% cold, "
-            << required.lightning() << "% lightning, "
-            << required.chaos() << "% chaos " << std::endl;
+        print_required(std::cout, required);
         
         std::cout << "Using " << alg->name() <<  " algorithm ..." << std::endl;
 
@@ -468,10 +546,17 @@ int main(int argc, char** argv)
             auto begin = std::chrono::steady_clock::now();
             result = alg->find_minimal_reassignment(current, required, items, recipes);
             auto end = std::chrono::steady_clock::now();
+            if (trace::is_enabled())
+            {
+                trace::record("solve", "solve", begin, end);
+            }
             auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count();
 
             print_assignment(std::cout, result);
+            print_tolerance();
             std::cout << duration << " ms" << std::endl;
+            print_stats();
+            write_trace();
         }
         else 
         {
@@ -484,10 +569,17 @@ int main(int argc, char** argv)
             auto begin = std::chrono::steady_clock::now();
             result = alg->find_minimal_assignment(required, slots, recipes);
             auto end = std::chrono::steady_clock::now();
+            if (trace::is_enabled())
+            {
+                trace::record("solve", "solve", begin, end);
+            }
             auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count();
 
             print_assignment(std::cout, result);
+            print_tolerance();
             std::cout << duration << " ms" << std::endl;
+            print_stats();
+            write_trace();
         }
     }
     catch (invalid_input_error& err)
@@ -510,6 +602,11 @@ int main(int argc, char** argv)
         std::cerr << err.what() << std::endl;
         return 1;
     }
+    catch (std::runtime_error& err)
+    {
+        std::cerr << err.what() << std::endl;
+        return 1;
+    }
 
     return 0;
 }
\ No newline at end of file
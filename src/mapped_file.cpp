@@ -0,0 +1,53 @@
+#include "mapped_file.hpp"
+
+#include <stdexcept>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+recap::mapped_file::mapped_file(const std::string& path) : data_(nullptr), size_(0)
+{
+    auto fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw std::runtime_error{ "Can't open " + path + ": " + std::strerror(errno) };
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0)
+    {
+        auto error = errno;
+        ::close(fd);
+        throw std::runtime_error{ "Can't read size of " + path + ": " + std::strerror(error) };
+    }
+
+    size_ = static_cast<std::size_t>(info.st_size);
+
+    // it is not possible to map an empty file
+    if (size_ > 0)
+    {
+        data_ = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        if (data_ == MAP_FAILED)
+        {
+            auto error = errno;
+            ::close(fd);
+            data_ = nullptr;
+            throw std::runtime_error{ "Can't map " + path + ": " + std::strerror(error) };
+        }
+    }
+
+    // the mapping stays valid after the file is closed
+    ::close(fd);
+}
+
+recap::mapped_file::~mapped_file()
+{
+    if (data_ != nullptr)
+    {
+        ::munmap(data_, size_);
+    }
+}
\ No newline at end of file
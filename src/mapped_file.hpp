@@ -0,0 +1,60 @@
+#ifndef RECAP_MAPPED_FILE_HPP_
+#define RECAP_MAPPED_FILE_HPP_
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace recap
+{
+    /** Read-only memory mapping of a whole file (RAII).
+     * 
+     * Pages are loaded lazily by the OS so mapping a large file is cheap and 
+     * the data can be shared by multiple processes.
+     */
+    class mapped_file
+    {
+    public:
+        /** Map file @p path to memory
+         * 
+         * @param path Path to a file
+         * 
+         * @throws std::runtime_error if the file can't be opened or mapped
+         */
+        explicit mapped_file(const std::string& path);
+
+        ~mapped_file();
+
+        // Non-copyable
+        mapped_file(const mapped_file&) = delete;
+        mapped_file& operator=(const mapped_file&) = delete;
+
+        // Non-movable
+        mapped_file(mapped_file&&) = delete;
+        mapped_file& operator=(mapped_file&&) = delete;
+
+        /** Get mapped memory
+         * 
+         * @returns pointer to the first byte of the file (aligned to the page size)
+         */
+        inline const std::uint8_t* data() const
+        {
+            return static_cast<const std::uint8_t*>(data_);
+        }
+
+        /** Get size of the mapped file
+         * 
+         * @returns number of bytes
+         */
+        inline std::size_t size() const
+        {
+            return size_;
+        }
+
+    private:
+        void* data_;
+        std::size_t size_;
+    };
+}
+
+#endif // RECAP_MAPPED_FILE_HPP_
\ No newline at end of file
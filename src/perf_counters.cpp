@@ -0,0 +1,149 @@
+#include "perf_counters.hpp"
+
+#ifdef __linux__
+#include <cstring>
+
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+namespace
+{
+    /** Configuration of a counted event
+     */
+    struct event_config
+    {
+        std::uint32_t type;
+        std::uint64_t config;
+    };
+
+    /** Configuration of a read miss event of @p cache
+     */
+    constexpr event_config make_cache_miss(std::uint64_t cache)
+    {
+        return event_config{
+            PERF_TYPE_HW_CACHE,
+            cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)
+        };
+    }
+
+    // events in the order of fields of hardware_counters (cycles have to be first, they lead the group)
+    constexpr std::array<event_config, 5> events{
+        event_config{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        event_config{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        make_cache_miss(PERF_COUNT_HW_CACHE_L1D),
+        make_cache_miss(PERF_COUNT_HW_CACHE_LL),
+        event_config{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    };
+
+    /** Open a counter of @p event for the calling thread in group @p group_fd (-1 opens a new group)
+     *
+     * @returns file descriptor or -1 if the event can't be counted
+     */
+    int open_event(const event_config& event, int group_fd)
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = event.type;
+        attr.config = event.config;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        // unprivileged processes can only count user space events
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+
+        return static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0));
+    }
+}
+
+recap::perf_counters::perf_counters()
+{
+    static_assert(events.size() == EVENT_COUNT);
+
+    fds_.fill(-1);
+    fds_[0] = open_event(events[0], -1);
+    if (fds_[0] < 0)
+    {
+        return;
+    }
+
+    for (std::size_t i = 1; i < EVENT_COUNT; ++i)
+    {
+        fds_[i] = open_event(events[i], fds_[0]);
+    }
+}
+
+recap::perf_counters::~perf_counters()
+{
+    for (auto fd : fds_)
+    {
+        if (fd >= 0)
+        {
+            ::close(fd);
+        }
+    }
+}
+
+recap::hardware_counters recap::perf_counters::read() const
+{
+    hardware_counters result;
+    if (!is_available())
+    {
+        return result;
+    }
+
+    // number of events, time enabled, time running and a value of each event in the group
+    std::array<std::uint64_t, 3 + EVENT_COUNT> buffer{};
+    if (::read(fds_[0], buffer.data(), sizeof(buffer)) < static_cast<ssize_t>(3 * sizeof(std::uint64_t)))
+    {
+        return result;
+    }
+
+    // the group was only counting for a fraction of the time if counters are multiplexed
+    auto enabled = buffer[1];
+    auto running = buffer[2];
+    auto scale = [&](std::uint64_t value)
+    {
+        if (running == 0 || running >= enabled)
+        {
+            return value;
+        }
+        return static_cast<std::uint64_t>(static_cast<double>(value) * enabled / running);
+    };
+
+    // values are in the order in which the events have been added to the group
+    std::array<std::uint64_t, EVENT_COUNT> values{};
+    std::size_t next = 3;
+    for (std::size_t i = 0; i < EVENT_COUNT && next < 3 + buffer[0]; ++i)
+    {
+        if (fds_[i] >= 0)
+        {
+            values[i] = scale(buffer[next++]);
+        }
+    }
+
+    result.cycles = values[0];
+    result.instructions = values[1];
+    result.l1d_misses = values[2];
+    result.llc_misses = values[3];
+    result.branch_misses = values[4];
+    return result;
+}
+
+#else // __linux__
+
+recap::perf_counters::perf_counters()
+{
+    fds_.fill(-1);
+}
+
+recap::perf_counters::~perf_counters()
+{
+}
+
+recap::hardware_counters recap::perf_counters::read() const
+{
+    return hardware_counters{};
+}
+
+#endif // __linux__
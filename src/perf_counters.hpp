@@ -0,0 +1,115 @@
+#ifndef RECAP_PERF_COUNTERS_HPP_
+#define RECAP_PERF_COUNTERS_HPP_
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+namespace recap
+{
+    /** Values of hardware performance counters
+     */
+    struct hardware_counters
+    {
+        std::uint64_t cycles = 0;
+        std::uint64_t instructions = 0;
+        // L1 data cache read misses
+        std::uint64_t l1d_misses = 0;
+        // Last level cache read misses
+        std::uint64_t llc_misses = 0;
+        std::uint64_t branch_misses = 0;
+
+        inline hardware_counters& operator+=(const hardware_counters& other)
+        {
+            cycles += other.cycles;
+            instructions += other.instructions;
+            l1d_misses += other.l1d_misses;
+            llc_misses += other.llc_misses;
+            branch_misses += other.branch_misses;
+            return *this;
+        }
+
+        inline hardware_counters operator-(const hardware_counters& other) const
+        {
+            hardware_counters result;
+            result.cycles = cycles - other.cycles;
+            result.instructions = instructions - other.instructions;
+            result.l1d_misses = l1d_misses - other.l1d_misses;
+            result.llc_misses = llc_misses - other.llc_misses;
+            result.branch_misses = branch_misses - other.branch_misses;
+            return result;
+        }
+
+        /** Instructions per cycle
+         *
+         * @returns 0 if no cycles have been counted
+         */
+        inline double ipc() const
+        {
+            return cycles > 0 ? static_cast<double>(instructions) / cycles : 0;
+        }
+
+        /** Number of @p events per 1000 instructions
+         *
+         * @param events Number of events (e.g., l1d_misses)
+         *
+         * @returns 0 if no instructions have been counted
+         */
+        inline double per_kilo_instruction(std::uint64_t events) const
+        {
+            return instructions > 0 ? 1000.0 * events / instructions : 0;
+        }
+    };
+
+    /** Group of hardware performance counters of the calling thread opened with perf_event_open (RAII).
+     *
+     * Only user space events are counted. Counters which the CPU (or a virtual machine) doesn't
+     * support stay at 0. If the kernel doesn't allow to count cycles, the group is not
+     * available and all counters stay at 0.
+     */
+    class perf_counters
+    {
+    public:
+        /** Start counting events of the calling thread
+         */
+        perf_counters();
+
+        ~perf_counters();
+
+        // Non-copyable
+        perf_counters(const perf_counters&) = delete;
+        perf_counters& operator=(const perf_counters&) = delete;
+
+        // Non-movable
+        perf_counters(perf_counters&&) = delete;
+        perf_counters& operator=(perf_counters&&) = delete;
+
+        /** Check whether the counters could be opened
+         *
+         * @returns true iff at least cycles are counted
+         */
+        inline bool is_available() const
+        {
+            return fds_[0] >= 0;
+        }
+
+        /** Read current values of the counters (the values only grow, subtract two readings
+         * to count events between them)
+         *
+         * Values are scaled by the fraction of time the group has been scheduled on the
+         * CPU if the kernel multiplexes counters.
+         *
+         * @returns values of the counters since the creation of this object
+         */
+        hardware_counters read() const;
+
+    private:
+        // Number of counted events
+        inline static constexpr std::size_t EVENT_COUNT = 5;
+
+        // File descriptor of each event (the first one is the group leader), -1 if it is not counted
+        std::array<int, EVENT_COUNT> fds_;
+    };
+}
+
+#endif // RECAP_PERF_COUNTERS_HPP_
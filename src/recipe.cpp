@@ -1,4 +1,8 @@
 #include "recipe.hpp"
+#include "trace.hpp"
+
+#include <cstring>
+#include <algorithm>
 
 std::string recap::to_string(recipe::slot_t slot)
 {
@@ -109,4 +113,167 @@ recap::recipe::slot_t recap::parse_slot(const std::string& slot)
         return recipe::SLOT_AMULET;
     }
     return recipe::SLOT_NONE;
+}
+
+std::size_t recap::remove_dominated_recipes(std::vector<recipe>& recipes)
+{
+    trace::span span{ "remove dominated recipes", "recipes", "recipes", static_cast<std::int64_t>(recipes.size()) };
+
+    // check whether recipe at index a can replace recipe at index b (ignoring slots)
+    auto can_replace = [&recipes](std::size_t a, std::size_t b)
+    {
+        const auto& lhs = recipes[a];
+        const auto& rhs = recipes[b];
+        if (!(lhs.resistances() >= rhs.resistances()) || lhs.cost() > rhs.cost())
+        {
+            return false;
+        }
+
+        // if the recipes are equal, only the first one is kept
+        return lhs.resistances() != rhs.resistances() || lhs.cost() < rhs.cost() || a < b;
+    };
+
+    std::vector<bool> is_dominated(recipes.size(), false);
+    for (std::size_t i = 0; i < recipes.size(); ++i)
+    {
+        // slots where recipe i isn't dominated yet
+        std::uint32_t remaining_slots = recipes[i].slots();
+        for (std::size_t j = 0; j < recipes.size() && remaining_slots != recipe::SLOT_NONE; ++j)
+        {
+            if (i != j && can_replace(j, i))
+            {
+                remaining_slots &= ~static_cast<std::uint32_t>(recipes[j].slots());
+            }
+        }
+        is_dominated[i] = remaining_slots == recipe::SLOT_NONE;
+    }
+
+    // remove dominated recipes but keep order of the rest
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < recipes.size(); ++i)
+    {
+        if (!is_dominated[i])
+        {
+            recipes[count++] = recipes[i];
+        }
+    }
+
+    auto removed = recipes.size() - count;
+    recipes.resize(count);
+    return removed;
+}
+
+std::vector<std::size_t> recap::find_layer_recipes(
+    const std::vector<recipe>& recipes, 
+    recipe::slot_t slot, 
+    resistance max_resistances)
+{
+    // excess resistances are wasted
+    auto clamp = [max_resistances](resistance res)
+    {
+        return resistance{
+            std::min(res.fire(), max_resistances.fire()),
+            std::min(res.cold(), max_resistances.cold()),
+            std::min(res.lightning(), max_resistances.lightning()),
+            std::min(res.chaos(), max_resistances.chaos())
+        };
+    };
+
+    std::vector<std::size_t> candidates;
+    std::vector<resistance> clamped;
+    for (std::size_t i = 0; i < recipes.size(); ++i)
+    {
+        if ((recipes[i].slots() & slot) != 0)
+        {
+            candidates.push_back(i);
+            clamped.push_back(clamp(recipes[i].resistances()));
+        }
+    }
+
+    // check whether candidate a can replace candidate b
+    auto can_replace = [&](std::size_t a, std::size_t b)
+    {
+        auto lhs_cost = recipes[candidates[a]].cost();
+        auto rhs_cost = recipes[candidates[b]].cost();
+        if (!(clamped[a] >= clamped[b]) || lhs_cost > rhs_cost)
+        {
+            return false;
+        }
+
+        // if the recipes are equal, only the first one is kept
+        return clamped[a] != clamped[b] || lhs_cost < rhs_cost || a < b;
+    };
+
+    std::vector<std::size_t> result;
+    for (std::size_t i = 0; i < candidates.size(); ++i)
+    {
+        bool is_dominated = false;
+        for (std::size_t j = 0; j < candidates.size() && !is_dominated; ++j)
+        {
+            is_dominated = i != j && can_replace(j, i);
+        }
+
+        if (!is_dominated)
+        {
+            result.push_back(candidates[i]);
+        }
+    }
+    return result;
+}
+
+namespace
+{
+    // FNV-1a
+    class fnv_hash
+    {
+    public:
+        inline void combine(std::uint64_t value)
+        {
+            for (int i = 0; i < 8; ++i)
+            {
+                hash_ ^= (value >> (i * 8)) & 0xFF;
+                hash_ *= 1099511628211ull;
+            }
+        }
+
+        inline std::uint64_t value() const
+        {
+            return hash_;
+        }
+
+    private:
+        std::uint64_t hash_ = 14695981039346656037ull;
+    };
+}
+
+std::uint64_t recap::hash_recipes(const std::vector<recipe>& recipes)
+{
+    fnv_hash hash;
+    hash.combine(recipes.size());
+    for (auto& rec : recipes)
+    {
+        std::uint32_t cost_bits;
+        recipe::cost_t cost = rec.cost();
+        static_assert(sizeof(cost_bits) == sizeof(cost));
+        std::memcpy(&cost_bits, &cost, sizeof(cost_bits));
+
+        hash.combine(rec.resistances().fire());
+        hash.combine(rec.resistances().cold());
+        hash.combine(rec.resistances().lightning());
+        hash.combine(rec.resistances().chaos());
+        hash.combine(cost_bits);
+        hash.combine(rec.slots());
+    }
+    return hash.value();
+}
+
+std::uint64_t recap::hash_slots(const std::vector<recipe::slot_t>& slots)
+{
+    fnv_hash hash;
+    hash.combine(slots.size());
+    for (auto slot : slots)
+    {
+        hash.combine(slot);
+    }
+    return hash.value();
 }
\ No newline at end of file
@@ -80,6 +80,20 @@ namespace recap
             return slots_;
         }
 
+        // comparison operators
+
+        inline bool operator==(const recipe& other) const
+        {
+            return resistances() == other.resistances() && 
+                cost() == other.cost() && 
+                slots() == other.slots();
+        }
+
+        inline bool operator!=(const recipe& other) const
+        {
+            return !operator==(other);
+        }
+
     private:
         resistance res_;
         cost_t cost_;
@@ -101,6 +115,57 @@ namespace recap
      * @returns slot
      */
     recipe::slot_t parse_slot(const std::string& value);
+
+    /** Remove recipes which are never needed in an optimal assignment.
+     * 
+     * A recipe is dominated in a slot if there is another recipe aplicable to that slot 
+     * which has at least the same resistances and at most the same cost. If a recipe is 
+     * dominated in all of its slots, it can be removed. Only the first of equal recipes 
+     * is kept. Order of the remaining recipes is preserved.
+     * 
+     * @param recipes Recipes (dominated recipes are removed from this list)
+     * 
+     * @returns number of removed recipes
+     */
+    std::size_t remove_dominated_recipes(std::vector<recipe>& recipes);
+
+    /** Find recipes which have to be tried in a layer with slot @p slot.
+     * 
+     * A recipe is aplicable to the layer if it shares a slot bit with @p slot. Aplicable 
+     * recipes dominated by another aplicable recipe are skipped. Resistances are compared 
+     * after clamping them to @p max_resistances since any excess resistance is wasted.
+     * Only the first of equal recipes is kept.
+     * 
+     * @param recipes All recipes
+     * @param slot Slot (mask) of the layer
+     * @param max_resistances Maximal required resistances
+     * 
+     * @returns sorted indices of recipes in @p recipes
+     */
+    std::vector<std::size_t> find_layer_recipes(
+        const std::vector<recipe>& recipes, 
+        recipe::slot_t slot, 
+        resistance max_resistances);
+
+    /** Compute hash of @p recipes (it depends on the order of recipes).
+     * 
+     * The hash is stable across runs and platforms.
+     * 
+     * @param recipes List of recipes
+     * 
+     * @returns 64-bit hash
+     */
+    std::uint64_t hash_recipes(const std::vector<recipe>& recipes);
+
+    /** Compute hash of @p slots (it depends on the order of slots).
+     * 
+     * The hash is stable across runs and platforms.
+     * 
+     * @param slots List of slots
+     * 
+     * @returns 64-bit hash
+     */
+    std::uint64_t hash_slots(const std::vector<recipe::slot_t>& slots);
 }
 
 #endif // RECAP_RECIPE_HPP_
\ No newline at end of file
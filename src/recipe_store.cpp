@@ -0,0 +1,101 @@
+#include "recipe_store.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <limits>
+
+void recap::recipe_store::compile(
+    const std::vector<recipe>& recipes,
+    const std::vector<recipe::slot_t>& slots,
+    resistance max_resistances)
+{
+    compile(recipes, slots, max_resistances, table_layout{ layout_kind::dense, max_resistances });
+}
+
+void recap::recipe_store::compile(
+    const std::vector<recipe>& recipes,
+    const std::vector<recipe::slot_t>& slots,
+    resistance max_resistances,
+    const table_layout& layout)
+{
+    trace::span span{ "compile recipes", "recipes", "layers", static_cast<std::int64_t>(slots.size()) };
+
+    if (recipes.size() > std::size_t{ std::numeric_limits<recipe_index_t>::max() } + 1)
+    {
+        throw std::runtime_error{ "Recipes won't fit into used index type." };
+    }
+
+    group_slots_.clear();
+    group_max_.clear();
+    group_begin_.clear();
+    layer_group_.resize(slots.size());
+
+    fire_.clear();
+    cold_.clear();
+    lightning_.clear();
+    chaos_.clear();
+    offsets_.clear();
+    costs_.clear();
+    indices_.clear();
+
+    for (std::size_t i = 0; i < slots.size(); ++i)
+    {
+        auto it = std::find(group_slots_.begin(), group_slots_.end(), slots[i]);
+        layer_group_[i] = it - group_slots_.begin();
+        if (it != group_slots_.end())
+        {
+            continue;
+        }
+
+        group_slots_.push_back(slots[i]);
+        group_begin_.push_back(costs_.size());
+
+        auto max_delta = resistance::make_zero();
+        for (auto recipe_index : find_layer_recipes(recipes, slots[i], max_resistances))
+        {
+            const auto& item = recipes[recipe_index];
+
+            // excess resistances are wasted
+            resistance delta{
+                std::min(item.resistances().fire(), max_resistances.fire()),
+                std::min(item.resistances().cold(), max_resistances.cold()),
+                std::min(item.resistances().lightning(), max_resistances.lightning()),
+                std::min(item.resistances().chaos(), max_resistances.chaos())
+            };
+
+            fire_.push_back(delta.fire());
+            cold_.push_back(delta.cold());
+            lightning_.push_back(delta.lightning());
+            chaos_.push_back(delta.chaos());
+            offsets_.push_back(layout.index(delta));
+            costs_.push_back(item.cost());
+            indices_.push_back(static_cast<recipe_index_t>(recipe_index));
+
+            max_delta = resistance{
+                std::max(max_delta.fire(), delta.fire()),
+                std::max(max_delta.cold(), delta.cold()),
+                std::max(max_delta.lightning(), delta.lightning()),
+                std::max(max_delta.chaos(), delta.chaos())
+            };
+        }
+        group_max_.push_back(max_delta);
+    }
+    group_begin_.push_back(costs_.size());
+}
+
+recap::recipe_store::recipe_list recap::recipe_store::group(std::size_t group) const
+{
+    auto begin = group_begin_[group];
+
+    recipe_list result;
+    result.fire = fire_.data() + begin;
+    result.cold = cold_.data() + begin;
+    result.lightning = lightning_.data() + begin;
+    result.chaos = chaos_.data() + begin;
+    result.offsets = offsets_.data() + begin;
+    result.costs = costs_.data() + begin;
+    result.indices = indices_.data() + begin;
+    result.count = group_begin_[group + 1] - begin;
+    return result;
+}
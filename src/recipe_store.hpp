@@ -0,0 +1,243 @@
+#ifndef RECAP_RECIPE_STORE_HPP_
+#define RECAP_RECIPE_STORE_HPP_
+
+#include <vector>
+#include <new>
+#include <cstdint>
+#include <cstddef>
+
+#include "recipe.hpp"
+#include "resistance.hpp"
+#include "table_layout.hpp"
+
+namespace recap
+{
+    /** Allocator which aligns arrays to @p Alignment bytes
+     */
+    template<typename T, std::size_t Alignment>
+    class aligned_allocator
+    {
+    public:
+        using value_type = T;
+
+        template<typename U>
+        struct rebind
+        {
+            using other = aligned_allocator<U, Alignment>;
+        };
+
+        aligned_allocator() = default;
+
+        template<typename U>
+        aligned_allocator(const aligned_allocator<U, Alignment>&) {}
+
+        inline T* allocate(std::size_t count)
+        {
+            return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t{ Alignment }));
+        }
+
+        inline void deallocate(T* ptr, std::size_t)
+        {
+            ::operator delete(ptr, std::align_val_t{ Alignment });
+        }
+
+        template<typename U>
+        inline bool operator==(const aligned_allocator<U, Alignment>&) const
+        {
+            return true;
+        }
+
+        template<typename U>
+        inline bool operator!=(const aligned_allocator<U, Alignment>&) const
+        {
+            return false;
+        }
+    };
+
+    /** Recipes compiled for the layers of one problem instance.
+     *
+     * Layers with the same slot mask form a group. Each group has a list of recipes which
+     * have to be tried in its layers (see find_layer_recipes()). Lists of all groups are
+     * stored one after another in structure-of-arrays layout: each property of recipes is
+     * a separate aligned array.
+     */
+    class recipe_store
+    {
+    public:
+        // Type used to index recipes in the choice tables
+        using recipe_index_t = std::uint8_t;
+        // Recipe cost type
+        using cost_t = recipe::cost_t;
+
+        // Alignment of the arrays in bytes
+        inline static constexpr std::size_t ALIGNMENT = 64;
+
+        template<typename T>
+        using array_t = std::vector<T, aligned_allocator<T, ALIGNMENT>>;
+
+        /** Recipes of one group (pointers to the arrays of the store)
+         */
+        struct recipe_list
+        {
+            // Resistances added by the recipes (clamped to maximal resistances)
+            const resistance::item_t* fire;
+            const resistance::item_t* cold;
+            const resistance::item_t* lightning;
+            const resistance::item_t* chaos;
+            // Index of the resistances of each recipe in the table
+            const std::size_t* offsets;
+            // Cost of the recipes
+            const cost_t* costs;
+            // Index of the recipes in the original list
+            const recipe_index_t* indices;
+            // Number of recipes
+            std::size_t count;
+
+            /** Get resistances added by recipe @p k
+             *
+             * @param k Index of the recipe in this list
+             *
+             * @returns resistances
+             */
+            inline resistance resistances(std::size_t k) const
+            {
+                return resistance{ fire[k], cold[k], lightning[k], chaos[k] };
+            }
+        };
+
+        /** Compile @p recipes for layers with @p slots
+         *
+         * Allocated memory is reused if possible.
+         *
+         * @param recipes All recipes (there can be at most 256 recipes)
+         * @param slots Slot (mask) of each layer
+         * @param max_resistances Dimensions of the table (resistances of recipes are clamped to them)
+         */
+        void compile(
+            const std::vector<recipe>& recipes,
+            const std::vector<recipe::slot_t>& slots,
+            resistance max_resistances);
+
+        /** Compile @p recipes for layers with @p slots of a table with @p layout
+         *
+         * Allocated memory is reused if possible.
+         *
+         * @param recipes All recipes (there can be at most 256 recipes)
+         * @param slots Slot (mask) of each layer
+         * @param max_resistances Dimensions of the table (resistances of recipes are clamped to them)
+         * @param layout Layout of the table used to compute offsets of recipes
+         */
+        void compile(
+            const std::vector<recipe>& recipes,
+            const std::vector<recipe::slot_t>& slots,
+            resistance max_resistances,
+            const table_layout& layout);
+
+        /** Number of distinct slot masks
+         *
+         * @returns number of groups
+         */
+        inline std::size_t group_count() const
+        {
+            return group_slots_.size();
+        }
+
+        /** Find group of a layer
+         *
+         * @param layer Index of the layer
+         *
+         * @returns index of the group
+         */
+        inline std::size_t layer_group(std::size_t layer) const
+        {
+            return layer_group_[layer];
+        }
+
+        /** Slot mask of a group
+         *
+         * @param group Index of the group
+         *
+         * @returns slot mask
+         */
+        inline recipe::slot_t group_slot(std::size_t group) const
+        {
+            return group_slots_[group];
+        }
+
+        /** Maximal resistances added by recipes of a group in each dimension
+         *
+         * @param group Index of the group
+         *
+         * @returns maximal resistances
+         */
+        inline resistance group_max_resistances(std::size_t group) const
+        {
+            return group_max_[group];
+        }
+
+        /** Position of a group in the arrays of the store
+         *
+         * @param group Index of the group
+         *
+         * @returns index of the first recipe of the group
+         */
+        inline std::size_t group_begin(std::size_t group) const
+        {
+            return group_begin_[group];
+        }
+
+        /** Recipes which have to be tried in layers of a group
+         *
+         * @param group Index of the group
+         *
+         * @returns list of recipes
+         */
+        recipe_list group(std::size_t group) const;
+
+        /** Recipes which have to be tried in a layer
+         *
+         * @param layer Index of the layer
+         *
+         * @returns list of recipes
+         */
+        inline recipe_list layer(std::size_t layer) const
+        {
+            return group(layer_group(layer));
+        }
+
+        /** Number of recipes in all groups
+         *
+         * @returns size of each array
+         */
+        inline std::size_t size() const
+        {
+            return costs_.size();
+        }
+
+        // Arrays of all groups
+        inline const array_t<resistance::item_t>& fire() const { return fire_; }
+        inline const array_t<resistance::item_t>& cold() const { return cold_; }
+        inline const array_t<resistance::item_t>& lightning() const { return lightning_; }
+        inline const array_t<resistance::item_t>& chaos() const { return chaos_; }
+        inline const array_t<std::size_t>& offsets() const { return offsets_; }
+        inline const array_t<cost_t>& costs() const { return costs_; }
+        inline const array_t<recipe_index_t>& indices() const { return indices_; }
+
+    private:
+        std::vector<recipe::slot_t> group_slots_;
+        std::vector<resistance> group_max_;
+        // Group begin in the arrays (the last element is the total number of recipes)
+        std::vector<std::size_t> group_begin_;
+        std::vector<std::size_t> layer_group_;
+
+        array_t<resistance::item_t> fire_;
+        array_t<resistance::item_t> cold_;
+        array_t<resistance::item_t> lightning_;
+        array_t<resistance::item_t> chaos_;
+        array_t<std::size_t> offsets_;
+        array_t<cost_t> costs_;
+        array_t<recipe_index_t> indices_;
+    };
+}
+
+#endif // RECAP_RECIPE_STORE_HPP_
@@ -3,14 +3,22 @@
 
 #include <cassert>
 #include <cstdint>
+#include <cstring>
+#include <cstddef>
 
 namespace recap
 {
-    // 4-tuple of resistances (immutable)
+    /** 4-tuple of resistances (immutable)
+     * 
+     * Values are stored in 16-bit lanes of one 8-byte word. Comparisons check all lanes at once 
+     * in a 64-bit integer. Addition and subtraction are lane-wise loops without branches which 
+     * compilers turn into packed (saturating) SIMD instructions.
+     */
     class resistance
     {
     public:
         using item_t = std::uint16_t; 
+        using packed_t = std::uint64_t;
 
         // DefaultConstructible
         resistance() = default;
@@ -20,10 +28,7 @@ namespace recap
         resistance& operator=(const resistance&) = default;
         
         inline resistance(item_t fire, item_t cold, item_t lightning, item_t chaos) : 
-            fire_(fire), 
-            cold_(cold), 
-            lightning_(lightning), 
-            chaos_(chaos)
+            values_{ fire, cold, lightning, chaos }
         {
         }
 
@@ -42,7 +47,7 @@ namespace recap
          */
         inline item_t fire() const
         {
-            return fire_;
+            return values_[0];
         }
         
         /** Get cold resistance
@@ -51,7 +56,7 @@ namespace recap
          */
         inline item_t cold() const
         {
-            return cold_;
+            return values_[1];
         }
         
         /** Get lightning resistance
@@ -60,7 +65,7 @@ namespace recap
          */
         inline item_t lightning() const
         {
-            return lightning_;
+            return values_[2];
         }
         
         /** Get chaos resistance
@@ -69,7 +74,7 @@ namespace recap
          */
         inline item_t chaos() const
         {
-            return chaos_;
+            return values_[3];
         }
 
         /** Add 2 resistances together
@@ -80,12 +85,12 @@ namespace recap
          */
         inline resistance operator+(const resistance& other) const
         {
-            return resistance{
-                static_cast<item_t>(fire() + other.fire()),
-                static_cast<item_t>(cold() + other.cold()),
-                static_cast<item_t>(lightning() + other.lightning()),
-                static_cast<item_t>(chaos() + other.chaos())
-            };
+            resistance result;
+            for (std::size_t i = 0; i < LANE_COUNT; ++i)
+            {
+                result.values_[i] = static_cast<item_t>(values_[i] + other.values_[i]);
+            }
+            return result;
         }
 
         /** Subtract a resistance object from this object.
@@ -98,54 +103,39 @@ namespace recap
          */
         inline resistance operator-(const resistance& other) const
         {
-            return resistance{
-                static_cast<item_t>(fire() >= other.fire() ? fire() - other.fire() : 0),
-                static_cast<item_t>(cold() >= other.cold() ? cold() - other.cold() : 0),
-                static_cast<item_t>(lightning() >= other.lightning() ? lightning() - other.lightning() : 0),
-                static_cast<item_t>(chaos() >= other.chaos() ? chaos() - other.chaos() : 0)
-            };
+            resistance result;
+            for (std::size_t i = 0; i < LANE_COUNT; ++i)
+            {
+                result.values_[i] = static_cast<item_t>(values_[i] >= other.values_[i] ? values_[i] - other.values_[i] : 0);
+            }
+            return result;
         }
         
-        // comparison operators
+        // comparison operators (a resistance is greater if all of its values are greater)
 
         inline bool operator>(const resistance& other) const
         {
-            return fire() > other.fire() && 
-                    cold() > other.cold() && 
-                    lightning() > other.lightning() && 
-                    chaos() > other.chaos();
+            return borrows(other.packed(), packed()) == HIGH_BITS;
         }
         
         inline bool operator>=(const resistance& other) const
         {
-            return fire() >= other.fire() && 
-                    cold() >= other.cold() && 
-                    lightning() >= other.lightning() && 
-                    chaos() >= other.chaos();
+            return borrows(packed(), other.packed()) == 0;
         }
 
         inline bool operator<=(const resistance& other) const
         {
-            return fire() <= other.fire() && 
-                    cold() <= other.cold() && 
-                    lightning() <= other.lightning() && 
-                    chaos() <= other.chaos();
+            return borrows(other.packed(), packed()) == 0;
         }
         
         inline bool operator<(const resistance& other) const
         {
-            return fire() < other.fire() && 
-                    cold() < other.cold() && 
-                    lightning() < other.lightning() && 
-                    chaos() < other.chaos();
+            return borrows(packed(), other.packed()) == HIGH_BITS;
         }
         
         inline bool operator==(const resistance& other) const
         {
-            return fire() == other.fire() && 
-                cold() == other.cold() && 
-                lightning() == other.lightning() && 
-                chaos() == other.chaos();
+            return packed() == other.packed();
         }
         
         inline bool operator!=(const resistance& other) const
@@ -153,11 +143,44 @@ namespace recap
             return !operator==(other);
         }
 
+        /** Values of all resistances in one integer
+         * 
+         * @returns fire, cold, lightning and chaos in 16-bit lanes (in memory order)
+         */
+        inline packed_t packed() const
+        {
+            packed_t result;
+            std::memcpy(&result, values_, sizeof(result));
+            return result;
+        }
+
     private:
-        item_t fire_;
-        item_t cold_;
-        item_t lightning_;
-        item_t chaos_;
+        // Number of resistance types
+        inline static constexpr std::size_t LANE_COUNT = 4;
+        // The highest bit of each lane
+        inline static constexpr packed_t HIGH_BITS = 0x8000800080008000;
+
+        alignas(sizeof(packed_t)) item_t values_[LANE_COUNT];
+
+        /** Subtract values in each lane (the result wraps around)
+         * 
+         * @returns @p lhs - @p rhs in each lane
+         */
+        inline static packed_t difference(packed_t lhs, packed_t rhs)
+        {
+            // set the highest bit of lhs lanes so that the lower 15 bits never borrow from other lanes
+            return ((lhs | HIGH_BITS) - (rhs & ~HIGH_BITS)) ^ ((lhs ^ ~rhs) & HIGH_BITS);
+        }
+
+        /** Find lanes where the subtraction borrows
+         * 
+         * @returns the highest bit of each lane where @p lhs < @p rhs
+         */
+        inline static packed_t borrows(packed_t lhs, packed_t rhs)
+        {
+            auto diff = difference(lhs, rhs);
+            return ((~lhs & rhs) | ((~lhs | rhs) & diff)) & HIGH_BITS;
+        }
     };
 }
 
@@ -0,0 +1,418 @@
+#include "layer_kernel.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define RECAP_X86 1
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    using recap::simd::cost_t;
+    using recap::simd::quantized_cost_t;
+    using recap::simd::recipe_index_t;
+    using recap::simd::MAX_QUANTIZED_COST;
+
+    /** Relax cells [begin, count) one at a time
+     */
+    inline std::size_t relax_tail(
+        cost_t* dst_cost,
+        recipe_index_t* dst_choice,
+        const cost_t* src_cost,
+        std::size_t begin,
+        std::size_t count,
+        cost_t cost,
+        recipe_index_t index)
+    {
+        std::size_t improved = 0;
+        for (std::size_t k = begin; k < count; ++k)
+        {
+            auto next_cost = src_cost[k] + cost;
+            if (next_cost < dst_cost[k])
+            {
+                dst_cost[k] = next_cost;
+                dst_choice[k] = index;
+                ++improved;
+            }
+        }
+        return improved;
+    }
+
+    std::size_t relax_run_scalar(
+        cost_t* dst_cost,
+        recipe_index_t* dst_choice,
+        const cost_t* src_cost,
+        std::size_t count,
+        cost_t cost,
+        recipe_index_t index)
+    {
+        return relax_tail(dst_cost, dst_choice, src_cost, 0, count, cost, index);
+    }
+
+    /** Relax cells [begin, count) with quantized costs one at a time
+     */
+    inline std::size_t relax_tail_quantized(
+        quantized_cost_t* dst_cost,
+        recipe_index_t* dst_choice,
+        const quantized_cost_t* src_cost,
+        std::size_t begin,
+        std::size_t count,
+        quantized_cost_t cost,
+        recipe_index_t index)
+    {
+        std::size_t improved = 0;
+        for (std::size_t k = begin; k < count; ++k)
+        {
+            auto sum = static_cast<unsigned>(src_cost[k]) + cost;
+            auto next_cost = static_cast<quantized_cost_t>(sum < MAX_QUANTIZED_COST ? sum : MAX_QUANTIZED_COST);
+            if (next_cost < dst_cost[k])
+            {
+                dst_cost[k] = next_cost;
+                dst_choice[k] = index;
+                ++improved;
+            }
+        }
+        return improved;
+    }
+
+    std::size_t relax_run_quantized_scalar(
+        quantized_cost_t* dst_cost,
+        recipe_index_t* dst_choice,
+        const quantized_cost_t* src_cost,
+        std::size_t count,
+        quantized_cost_t cost,
+        recipe_index_t index)
+    {
+        return relax_tail_quantized(dst_cost, dst_choice, src_cost, 0, count, cost, index);
+    }
+
+#ifdef RECAP_X86
+
+    /** Replace 8 recipe indices at @p dst_choice where @p mask (8 x 16 bit lanes) is set
+     */
+    __attribute__((target("sse4.2")))
+    inline void blend_choice8(recipe_index_t* dst_choice, __m128i mask, __m128i index)
+    {
+        auto mask8 = _mm_packs_epi16(mask, mask);
+        auto old_choice = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(dst_choice));
+        auto new_choice = _mm_blendv_epi8(old_choice, index, mask8);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst_choice), new_choice);
+    }
+
+    __attribute__((target("sse4.2")))
+    std::size_t relax_run_sse42(
+        cost_t* dst_cost,
+        recipe_index_t* dst_choice,
+        const cost_t* src_cost,
+        std::size_t count,
+        cost_t cost,
+        recipe_index_t index)
+    {
+        const auto cost_vec = _mm_set1_ps(cost);
+        const auto index_vec = _mm_set1_epi8(static_cast<char>(index));
+
+        std::size_t improved = 0;
+        std::size_t k = 0;
+        for (; k + 8 <= count; k += 8)
+        {
+            auto next_lo = _mm_add_ps(_mm_loadu_ps(src_cost + k), cost_vec);
+            auto next_hi = _mm_add_ps(_mm_loadu_ps(src_cost + k + 4), cost_vec);
+            auto current_lo = _mm_loadu_ps(dst_cost + k);
+            auto current_hi = _mm_loadu_ps(dst_cost + k + 4);
+            auto mask_lo = _mm_cmplt_ps(next_lo, current_lo);
+            auto mask_hi = _mm_cmplt_ps(next_hi, current_hi);
+
+            // most recipes don't improve anything
+            auto bits = _mm_movemask_ps(mask_lo) | (_mm_movemask_ps(mask_hi) << 4);
+            if (bits == 0)
+            {
+                continue;
+            }
+            improved += __builtin_popcount(bits);
+
+            _mm_storeu_ps(dst_cost + k, _mm_blendv_ps(current_lo, next_lo, mask_lo));
+            _mm_storeu_ps(dst_cost + k + 4, _mm_blendv_ps(current_hi, next_hi, mask_hi));
+
+            auto mask = _mm_packs_epi32(_mm_castps_si128(mask_lo), _mm_castps_si128(mask_hi));
+            blend_choice8(dst_choice + k, mask, index_vec);
+        }
+
+        return improved + relax_tail(dst_cost, dst_choice, src_cost, k, count, cost, index);
+    }
+
+    __attribute__((target("avx2")))
+    std::size_t relax_run_avx2(
+        cost_t* dst_cost,
+        recipe_index_t* dst_choice,
+        const cost_t* src_cost,
+        std::size_t count,
+        cost_t cost,
+        recipe_index_t index)
+    {
+        const auto cost_vec = _mm256_set1_ps(cost);
+        const auto index_vec = _mm_set1_epi8(static_cast<char>(index));
+
+        std::size_t improved = 0;
+        std::size_t k = 0;
+        for (; k + 8 <= count; k += 8)
+        {
+            auto next = _mm256_add_ps(_mm256_loadu_ps(src_cost + k), cost_vec);
+            auto current = _mm256_loadu_ps(dst_cost + k);
+            auto mask = _mm256_cmp_ps(next, current, _CMP_LT_OQ);
+
+            // most recipes don't improve anything
+            auto bits = _mm256_movemask_ps(mask);
+            if (bits == 0)
+            {
+                continue;
+            }
+            improved += __builtin_popcount(bits);
+
+            _mm256_storeu_ps(dst_cost + k, _mm256_blendv_ps(current, next, mask));
+
+            auto mask_int = _mm256_castps_si256(mask);
+            auto mask16 = _mm_packs_epi32(
+                _mm256_castsi256_si128(mask_int),
+                _mm256_extracti128_si256(mask_int, 1));
+            blend_choice8(dst_choice + k, mask16, index_vec);
+        }
+
+        return improved + relax_tail(dst_cost, dst_choice, src_cost, k, count, cost, index);
+    }
+
+    __attribute__((target("avx512f,avx512bw,avx512vl")))
+    std::size_t relax_run_avx512(
+        cost_t* dst_cost,
+        recipe_index_t* dst_choice,
+        const cost_t* src_cost,
+        std::size_t count,
+        cost_t cost,
+        recipe_index_t index)
+    {
+        const auto cost_vec = _mm512_set1_ps(cost);
+        const auto index_vec = _mm_set1_epi8(static_cast<char>(index));
+
+        std::size_t improved = 0;
+        std::size_t k = 0;
+        for (; k + 16 <= count; k += 16)
+        {
+            auto next = _mm512_add_ps(_mm512_loadu_ps(src_cost + k), cost_vec);
+            auto current = _mm512_loadu_ps(dst_cost + k);
+            auto mask = _mm512_cmp_ps_mask(next, current, _CMP_LT_OQ);
+
+            // most recipes don't improve anything
+            if (mask == 0)
+            {
+                continue;
+            }
+            improved += __builtin_popcount(mask);
+
+            _mm512_mask_storeu_ps(dst_cost + k, mask, next);
+            _mm_mask_storeu_epi8(dst_choice + k, mask, index_vec);
+        }
+
+        return improved + relax_tail(dst_cost, dst_choice, src_cost, k, count, cost, index);
+    }
+
+    __attribute__((target("sse4.2")))
+    std::size_t relax_run_quantized_sse42(
+        quantized_cost_t* dst_cost,
+        recipe_index_t* dst_choice,
+        const quantized_cost_t* src_cost,
+        std::size_t count,
+        quantized_cost_t cost,
+        recipe_index_t index)
+    {
+        const auto cost_vec = _mm_set1_epi16(static_cast<short>(cost));
+        const auto index_vec = _mm_set1_epi8(static_cast<char>(index));
+        const auto ones = _mm_set1_epi32(-1);
+
+        std::size_t improved = 0;
+        std::size_t k = 0;
+        for (; k + 8 <= count; k += 8)
+        {
+            auto next = _mm_adds_epu16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src_cost + k)), cost_vec);
+            auto current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst_cost + k));
+            auto best = _mm_min_epu16(next, current);
+            auto unchanged = _mm_cmpeq_epi16(best, current);
+
+            // most recipes don't improve anything (each lane sets 2 bits of the mask)
+            auto bits = _mm_movemask_epi8(unchanged);
+            if (bits == 0xFFFF)
+            {
+                continue;
+            }
+            improved += __builtin_popcount(~bits & 0xFFFF) / 2;
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst_cost + k), best);
+            blend_choice8(dst_choice + k, _mm_xor_si128(unchanged, ones), index_vec);
+        }
+
+        return improved + relax_tail_quantized(dst_cost, dst_choice, src_cost, k, count, cost, index);
+    }
+
+    __attribute__((target("avx2")))
+    std::size_t relax_run_quantized_avx2(
+        quantized_cost_t* dst_cost,
+        recipe_index_t* dst_choice,
+        const quantized_cost_t* src_cost,
+        std::size_t count,
+        quantized_cost_t cost,
+        recipe_index_t index)
+    {
+        const auto cost_vec = _mm256_set1_epi16(static_cast<short>(cost));
+        const auto index_vec = _mm_set1_epi8(static_cast<char>(index));
+        const auto ones = _mm256_set1_epi32(-1);
+
+        std::size_t improved = 0;
+        std::size_t k = 0;
+        for (; k + 16 <= count; k += 16)
+        {
+            auto next = _mm256_adds_epu16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src_cost + k)), cost_vec);
+            auto current = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst_cost + k));
+            auto best = _mm256_min_epu16(next, current);
+            auto unchanged = _mm256_cmpeq_epi16(best, current);
+
+            // most recipes don't improve anything (each lane sets 2 bits of the mask)
+            auto bits = _mm256_movemask_epi8(unchanged);
+            if (bits == -1)
+            {
+                continue;
+            }
+            improved += __builtin_popcount(~static_cast<unsigned>(bits)) / 2;
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst_cost + k), best);
+
+            // replace 16 recipe indices where the cost has changed
+            auto mask = _mm256_xor_si256(unchanged, ones);
+            auto mask8 = _mm_packs_epi16(_mm256_castsi256_si128(mask), _mm256_extracti128_si256(mask, 1));
+            auto old_choice = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst_choice + k));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst_choice + k), _mm_blendv_epi8(old_choice, index_vec, mask8));
+        }
+
+        return improved + relax_tail_quantized(dst_cost, dst_choice, src_cost, k, count, cost, index);
+    }
+
+    __attribute__((target("avx512f,avx512bw,avx512vl")))
+    std::size_t relax_run_quantized_avx512(
+        quantized_cost_t* dst_cost,
+        recipe_index_t* dst_choice,
+        const quantized_cost_t* src_cost,
+        std::size_t count,
+        quantized_cost_t cost,
+        recipe_index_t index)
+    {
+        const auto cost_vec = _mm512_set1_epi16(static_cast<short>(cost));
+        const auto index_vec = _mm256_set1_epi8(static_cast<char>(index));
+
+        std::size_t improved = 0;
+        std::size_t k = 0;
+        for (; k + 32 <= count; k += 32)
+        {
+            auto next = _mm512_adds_epu16(_mm512_loadu_si512(src_cost + k), cost_vec);
+            auto current = _mm512_loadu_si512(dst_cost + k);
+            auto mask = _mm512_cmplt_epu16_mask(next, current);
+
+            // most recipes don't improve anything
+            if (mask == 0)
+            {
+                continue;
+            }
+            improved += __builtin_popcount(mask);
+
+            _mm512_mask_storeu_epi16(dst_cost + k, mask, next);
+            _mm256_mask_storeu_epi8(dst_choice + k, mask, index_vec);
+        }
+
+        return improved + relax_tail_quantized(dst_cost, dst_choice, src_cost, k, count, cost, index);
+    }
+
+#endif // RECAP_X86
+}
+
+recap::simd::isa recap::simd::detect_isa()
+{
+    if (is_supported(isa::avx512))
+    {
+        return isa::avx512;
+    }
+    else if (is_supported(isa::avx2))
+    {
+        return isa::avx2;
+    }
+    else if (is_supported(isa::sse42))
+    {
+        return isa::sse42;
+    }
+    return isa::scalar;
+}
+
+bool recap::simd::is_supported(isa value)
+{
+    switch (value)
+    {
+        case isa::scalar:
+            return true;
+#ifdef RECAP_X86
+        case isa::sse42:
+            return __builtin_cpu_supports("sse4.2");
+        case isa::avx2:
+            return __builtin_cpu_supports("avx2");
+        case isa::avx512:
+            return __builtin_cpu_supports("avx512f") &&
+                __builtin_cpu_supports("avx512bw") &&
+                __builtin_cpu_supports("avx512vl");
+#endif // RECAP_X86
+        default:
+            return false;
+    }
+}
+
+recap::simd::relax_run_t recap::simd::get_relax_run(isa value)
+{
+    switch (value)
+    {
+#ifdef RECAP_X86
+        case isa::sse42:
+            return relax_run_sse42;
+        case isa::avx2:
+            return relax_run_avx2;
+        case isa::avx512:
+            return relax_run_avx512;
+#endif // RECAP_X86
+        default:
+            return relax_run_scalar;
+    }
+}
+
+recap::simd::relax_run_quantized_t recap::simd::get_relax_run_quantized(isa value)
+{
+    switch (value)
+    {
+#ifdef RECAP_X86
+        case isa::sse42:
+            return relax_run_quantized_sse42;
+        case isa::avx2:
+            return relax_run_quantized_avx2;
+        case isa::avx512:
+            return relax_run_quantized_avx512;
+#endif // RECAP_X86
+        default:
+            return relax_run_quantized_scalar;
+    }
+}
+
+const char* recap::simd::to_string(isa value)
+{
+    switch (value)
+    {
+        case isa::scalar:
+            return "scalar";
+        case isa::sse42:
+            return "sse4.2";
+        case isa::avx2:
+            return "avx2";
+        case isa::avx512:
+            return "avx512";
+    }
+    return "<unknown>";
+}
\ No newline at end of file
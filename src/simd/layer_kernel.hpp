@@ -0,0 +1,114 @@
+#ifndef RECAP_LAYER_KERNEL_HPP_
+#define RECAP_LAYER_KERNEL_HPP_
+
+#include <cstdint>
+#include <cstddef>
+
+#include "recipe.hpp"
+
+namespace recap
+{
+    namespace simd
+    {
+        using cost_t = recipe::cost_t;
+        using recipe_index_t = std::uint8_t;
+        // Fixed-point cost used by the quantized kernels
+        using quantized_cost_t = std::uint16_t;
+
+        // Quantized cost of unreachable cells (additions saturate at this value)
+        inline constexpr quantized_cost_t MAX_QUANTIZED_COST = 0xFFFF;
+
+        // Instruction sets the layer kernel is compiled for
+        enum class isa 
+        {
+            scalar,
+            sse42,
+            avx2,
+            avx512
+        };
+
+        /** Relax a contiguous run of table cells using one recipe.
+         * 
+         * For each k < count: if src_cost[k] + cost < dst_cost[k], the cost is replaced 
+         * and dst_choice[k] is set to index.
+         * 
+         * @param dst_cost Costs in the current layer
+         * @param dst_choice Recipes used in the current layer
+         * @param src_cost Costs in the previous layer (already shifted by the recipe)
+         * @param count Number of cells in the run
+         * @param cost Cost of the recipe
+         * @param index Index of the recipe
+         * 
+         * @returns number of replaced costs
+         */
+        using relax_run_t = std::size_t (*)(
+            cost_t* dst_cost, 
+            recipe_index_t* dst_choice, 
+            const cost_t* src_cost, 
+            std::size_t count, 
+            cost_t cost, 
+            recipe_index_t index);
+
+        /** Relax a contiguous run of table cells with quantized costs using one recipe.
+         * 
+         * For each k < count: if src_cost[k] + cost (saturated at MAX_QUANTIZED_COST) < dst_cost[k], 
+         * the cost is replaced and dst_choice[k] is set to index.
+         * 
+         * @param dst_cost Costs in the current layer
+         * @param dst_choice Recipes used in the current layer
+         * @param src_cost Costs in the previous layer (already shifted by the recipe)
+         * @param count Number of cells in the run
+         * @param cost Quantized cost of the recipe
+         * @param index Index of the recipe
+         * 
+         * @returns number of replaced costs
+         */
+        using relax_run_quantized_t = std::size_t (*)(
+            quantized_cost_t* dst_cost, 
+            recipe_index_t* dst_choice, 
+            const quantized_cost_t* src_cost, 
+            std::size_t count, 
+            quantized_cost_t cost, 
+            recipe_index_t index);
+
+        /** Find the best instruction set supported by this CPU
+         * 
+         * @returns best available instruction set
+         */
+        isa detect_isa();
+
+        /** Check whether this CPU supports @p value
+         * 
+         * @param value Instruction set
+         * 
+         * @returns true iff kernels for @p value can run on this CPU
+         */
+        bool is_supported(isa value);
+
+        /** Get kernel implementation for instruction set @p value
+         * 
+         * @param value Instruction set (it has to be supported by this CPU)
+         * 
+         * @returns kernel function
+         */
+        relax_run_t get_relax_run(isa value);
+
+        /** Get quantized kernel implementation for instruction set @p value
+         * 
+         * @param value Instruction set (it has to be supported by this CPU)
+         * 
+         * @returns kernel function
+         */
+        relax_run_quantized_t get_relax_run_quantized(isa value);
+
+        /** Convert @p value to a human readable string
+         * 
+         * @param value Instruction set
+         * 
+         * @returns name of the instruction set
+         */
+        const char* to_string(isa value);
+    }
+}
+
+#endif // RECAP_LAYER_KERNEL_HPP_
\ No newline at end of file
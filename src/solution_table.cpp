@@ -0,0 +1,168 @@
+#include "solution_table.hpp"
+
+recap::solution_table::solution_table(
+    resistance max_resistances,
+    const std::vector<recipe::slot_t>& slots,
+    std::shared_ptr<const void> storage,
+    const cost_t* costs,
+    const recipe_index_t* choices) :
+    max_res_(max_resistances),
+    layout_(layout_kind::dense, max_resistances),
+    value_count_(layout_.size()),
+    slots_(slots),
+    storage_(std::move(storage)),
+    cost_data_(costs),
+    choice_data_(choices)
+{
+}
+
+recap::solution_table::solution_table(const solution_table& other) :
+    max_res_(other.max_res_),
+    layout_(other.layout_),
+    value_count_(other.value_count_),
+    slots_(other.slots_),
+    costs_(other.costs_),
+    choices_(other.choices_),
+    storage_(other.storage_),
+    cost_data_(other.cost_data_),
+    choice_data_(other.choice_data_)
+{
+    update_data();
+}
+
+recap::solution_table& recap::solution_table::operator=(const solution_table& other)
+{
+    max_res_ = other.max_res_;
+    layout_ = other.layout_;
+    value_count_ = other.value_count_;
+    slots_ = other.slots_;
+    costs_ = other.costs_;
+    choices_ = other.choices_;
+    storage_ = other.storage_;
+    cost_data_ = other.cost_data_;
+    choice_data_ = other.choice_data_;
+    update_data();
+    return *this;
+}
+
+void recap::solution_table::update_data()
+{
+    if (!is_read_only())
+    {
+        cost_data_ = costs_.data();
+        choice_data_ = choices_.data();
+    }
+}
+
+void recap::solution_table::resize(resistance max_resistances, const std::vector<recipe::slot_t>& slots)
+{
+    resize(max_resistances, slots, layout_kind::dense);
+}
+
+void recap::solution_table::resize(
+    resistance max_resistances, 
+    const std::vector<recipe::slot_t>& slots, 
+    layout_kind kind)
+{
+    max_res_ = max_resistances;
+    slots_ = slots;
+    layout_ = table_layout{ kind, max_res_ };
+    value_count_ = layout_.size();
+
+    // the table won't use external storage anymore
+    storage_.reset();
+
+    // only grow the buffers so that we can reuse memory
+    if (costs_.size() < value_count_)
+    {
+        costs_.resize(value_count_);
+    }
+
+    if (choices_.size() < value_count_ * slots_.size())
+    {
+        choices_.resize(value_count_ * slots_.size());
+    }
+
+    update_data();
+}
+
+void recap::solution_table::shrink_to_fit()
+{
+    if (is_read_only())
+    {
+        return;
+    }
+
+    costs_.resize(value_count_);
+    costs_.shrink_to_fit();
+    choices_.resize(value_count_ * slots_.size());
+    choices_.shrink_to_fit();
+    update_data();
+}
+
+recap::assignment recap::solution_table::find_assignment(
+    resistance required,
+    const std::vector<recipe>& recipes) const
+{
+    return find_assignment(required, nullptr, recipes);
+}
+
+recap::assignment recap::solution_table::find_assignment(
+    resistance required,
+    const std::vector<resistance>& crafted,
+    const std::vector<recipe>& recipes) const
+{
+    assert(slots_.size() == crafted.size());
+
+    return find_assignment(required, &crafted, recipes);
+}
+
+recap::assignment recap::solution_table::find_assignment(
+    resistance required,
+    const std::vector<resistance>* crafted,
+    const std::vector<recipe>& recipes) const
+{
+    assert(contains(required));
+
+    const auto& slots = slots_;
+
+    // lookup the solution in the table
+    assignment result;
+    if (cost_data_[to_index(required)] != recipe::MAX_COST)
+    {
+        // follow recipes chosen in each layer back from the required resistances
+        std::vector<recipe_index_t> result_assignment(slots.size());
+        resistance current_resist = required;
+        for (std::size_t i = slots.size(); i-- > 0;)
+        {
+            auto index = choices(i)[to_index(current_resist)];
+            result_assignment[i] = index;
+
+            assert(index != KEEP_RECIPE || crafted != nullptr);
+            current_resist = current_resist - (index == KEEP_RECIPE ?
+                (*crafted)[i] :
+                recipes[index].resistances());
+        }
+
+        // add costs in the order of layers (this is the cost in the table unless the table has been
+        // computed with rounded costs)
+        result.cost() = 0;
+        for (std::size_t i = 0; i < slots.size(); ++i)
+        {
+            // this slot keeps its crafted resistances
+            if (result_assignment[i] == KEEP_RECIPE)
+            {
+                continue;
+            }
+
+            auto& used_recipe = recipes[result_assignment[i]];
+            result.cost() += used_recipe.cost();
+            if (used_recipe.resistances() != resistance::make_zero())
+            {
+                result.assignments().push_back(recipe_assignment{ slots[i], used_recipe });
+            }
+        }
+    }
+
+    return result;
+}
\ No newline at end of file
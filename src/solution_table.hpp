@@ -0,0 +1,304 @@
+#ifndef RECAP_SOLUTION_TABLE_HPP_
+#define RECAP_SOLUTION_TABLE_HPP_
+
+#include <vector>
+#include <memory>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+
+#include "recipe.hpp"
+#include "resistance.hpp"
+#include "assignment.hpp"
+#include "table_layout.hpp"
+
+namespace recap
+{
+    /** How an algorithm represents costs while it computes a table
+     */
+    enum class cost_precision
+    {
+        // costs of recipes (cost_t)
+        exact,
+        // 16-bit fixed-point costs (twice as many cells per SIMD instruction and two layers fit into 
+        // the cost table, so double buffering needs no second cost table; assignments can be 
+        // suboptimal by at most parallel_assignment::cost_tolerance())
+        quantized
+    };
+
+    /** Minimal cost of every resistance vector <= max_resistances() and recipes used
+     * in each layer (slot) of the dynamic programming algorithm.
+     *
+     * An assignment for any requirement inside the table is reconstructed by following
+     * the chosen recipes back from the required resistances.
+     *
+     * The table either owns its memory or it is a read-only view of external storage
+     * (e.g., a memory mapped file).
+     */
+    class solution_table
+    {
+    public:
+        // Type used to index recipes in the choice tables
+        using recipe_index_t = std::uint8_t;
+        // Recipe cost type
+        using cost_t = recipe::cost_t;
+
+        // Recipe index which marks that a slot keeps its crafted resistances
+        inline static constexpr recipe_index_t KEEP_RECIPE = std::numeric_limits<recipe_index_t>::max();
+
+        inline solution_table() :
+            max_res_(resistance::make_zero()),
+            value_count_(0),
+            cost_data_(nullptr),
+            choice_data_(nullptr)
+        {
+        }
+
+        /** Create a read-only table in external storage
+         *
+         * @param max_resistances Maximal resistances in the table
+         * @param slots Slot of each layer
+         * @param storage Object which owns the memory (it is kept alive by the table)
+         * @param costs Cost table in @p storage
+         * @param choices Choice tables of all layers (stored contiguously) in @p storage
+         */
+        solution_table(
+            resistance max_resistances,
+            const std::vector<recipe::slot_t>& slots,
+            std::shared_ptr<const void> storage,
+            const cost_t* costs,
+            const recipe_index_t* choices);
+
+        // Copyable
+        solution_table(const solution_table& other);
+        solution_table& operator=(const solution_table& other);
+
+        // Movable
+        solution_table(solution_table&&) = default;
+        solution_table& operator=(solution_table&&) = default;
+
+        /** Change dimensions of the table. Allocated memory is reused if possible.
+         *
+         * @param max_resistances Maximal resistances in the table
+         * @param slots Slot of each layer (one choice table is allocated for each slot)
+         */
+        void resize(resistance max_resistances, const std::vector<recipe::slot_t>& slots);
+
+        /** Change dimensions and order of cells of the table. Allocated memory is reused if possible.
+         *
+         * @param max_resistances Maximal resistances in the table
+         * @param slots Slot of each layer (one choice table is allocated for each slot)
+         * @param kind Order of cells in memory
+         */
+        void resize(resistance max_resistances, const std::vector<recipe::slot_t>& slots, layout_kind kind);
+
+        /** Release memory which is not used by the current dimensions of the table
+         */
+        void shrink_to_fit();
+
+        /** Check whether the table is a view of external storage
+         *
+         * @returns true iff the table can't be modified
+         */
+        inline bool is_read_only() const
+        {
+            return storage_ != nullptr;
+        }
+
+        /** Maximal resistances in the table
+         *
+         * @returns maximal resistances
+         */
+        inline resistance max_resistances() const
+        {
+            return max_res_;
+        }
+
+        /** Number of cells in the cost table and in each choice table
+         *
+         * @returns number of distinct resistance values <= max_resistances() (including gaps of the layout)
+         */
+        inline std::size_t value_count() const
+        {
+            return value_count_;
+        }
+
+        /** Order of cells in the cost table and in each choice table
+         *
+         * @returns layout of the tables
+         */
+        inline const table_layout& layout() const
+        {
+            return layout_;
+        }
+
+        /** Number of choice tables
+         *
+         * @returns number of slots used to compute this table
+         */
+        inline std::size_t layer_count() const
+        {
+            return slots_.size();
+        }
+
+        /** Slots used to compute this table
+         *
+         * @returns slot of each layer
+         */
+        inline const std::vector<recipe::slot_t>& slots() const
+        {
+            return slots_;
+        }
+
+        /** Memory used by the table (external storage is not included)
+         *
+         * @returns number of allocated bytes
+         */
+        inline std::size_t size_bytes() const
+        {
+            return costs_.capacity() * sizeof(cost_t) +
+                choices_.capacity() * sizeof(recipe_index_t) +
+                slots_.capacity() * sizeof(recipe::slot_t);
+        }
+
+        /** Check whether the table contains a solution for @p res
+         *
+         * @param res Resistances
+         *
+         * @returns true iff @p res <= max_resistances()
+         */
+        inline bool contains(resistance res) const
+        {
+            return res <= max_res_;
+        }
+
+        /** Convert resistance object to a linear index.
+         *
+         * This is a one-to-one mapping from resistances <= max_resistances() to [0, value_count() - 1]
+         * (see layout()). Chaos resistances are contiguous.
+         *
+         * @param res Resistances (<= max_resistances())
+         *
+         * @returns index in the cost table and in each choice table
+         */
+        inline std::size_t to_index(resistance res) const
+        {
+            assert(contains(res));
+            return layout_.index(res);
+        }
+
+        /** Minimal costs of all resistance values
+         *
+         * @returns cost table with value_count() cells
+         */
+        inline cost_t* costs()
+        {
+            assert(!is_read_only());
+            return costs_.data();
+        }
+
+        /** Minimal costs of all resistance values
+         *
+         * @returns cost table with value_count() cells
+         */
+        inline const cost_t* costs() const
+        {
+            return cost_data_;
+        }
+
+        /** Recipes used in layer @p layer
+         *
+         * @param layer Index of a slot
+         *
+         * @returns choice table with value_count() cells
+         */
+        inline recipe_index_t* choices(std::size_t layer)
+        {
+            assert(!is_read_only());
+            assert(layer < layer_count() || (layer == 0 && layer_count() == 0));
+            return choices_.data() + layer * value_count_;
+        }
+
+        /** Recipes used in layer @p layer
+         *
+         * @param layer Index of a slot
+         *
+         * @returns choice table with value_count() cells
+         */
+        inline const recipe_index_t* choices(std::size_t layer) const
+        {
+            assert(layer < layer_count() || (layer == 0 && layer_count() == 0));
+            return choice_data_ + layer * value_count_;
+        }
+
+        /** Exchange the cost table with @p buffer (used to double buffer layers)
+         *
+         * @param buffer Buffer with at least value_count() cells
+         */
+        inline void swap_costs(std::vector<cost_t>& buffer)
+        {
+            assert(!is_read_only());
+            assert(buffer.size() >= value_count_);
+            costs_.swap(buffer);
+            cost_data_ = costs_.data();
+        }
+
+        /** Reconstruct assignment with at least @p required resistances.
+         *
+         * @param required Required resistances (<= max_resistances())
+         * @param recipes Recipes used to compute this table
+         *
+         * @return assignment of recipes to slots or invalid assingment object if assignment is not possible.
+         */
+        assignment find_assignment(
+            resistance required,
+            const std::vector<recipe>& recipes) const;
+
+        /** Reconstruct assignment with at least @p required resistances if slots can keep
+         * their crafted resistances.
+         *
+         * @param required Required resistances (<= max_resistances())
+         * @param crafted Resistances crafted in each slot of slots()
+         * @param recipes Recipes used to compute this table
+         *
+         * @return assignment of recipes to recrafted slots or invalid assingment object if assignment is not possible.
+         */
+        assignment find_assignment(
+            resistance required,
+            const std::vector<resistance>& crafted,
+            const std::vector<recipe>& recipes) const;
+
+    private:
+        resistance max_res_;
+        table_layout layout_;
+        std::size_t value_count_;
+        std::vector<recipe::slot_t> slots_;
+        // memory owned by this table
+        std::vector<cost_t> costs_;
+        std::vector<recipe_index_t> choices_;
+        // external storage of a read-only table
+        std::shared_ptr<const void> storage_;
+        // tables used for lookups (either in owned memory or in the external storage)
+        const cost_t* cost_data_;
+        const recipe_index_t* choice_data_;
+
+        /** Point lookup tables to owned memory unless this is a read-only table
+         */
+        void update_data();
+
+        /** Reconstruct assignment with at least @p required resistances.
+         *
+         * @param required Required resistances (<= max_resistances())
+         * @param crafted Resistances crafted in each slot or nullptr if slots are empty
+         * @param recipes Recipes used to compute this table
+         *
+         * @return assignment of recipes to slots or invalid assingment object if assignment is not possible.
+         */
+        assignment find_assignment(
+            resistance required,
+            const std::vector<resistance>* crafted,
+            const std::vector<recipe>& recipes) const;
+    };
+}
+
+#endif // RECAP_SOLUTION_TABLE_HPP_
\ No newline at end of file
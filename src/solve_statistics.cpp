@@ -0,0 +1,183 @@
+#include "solve_statistics.hpp"
+
+#include <iomanip>
+
+void recap::solve_statistics::clear()
+{
+    layers.clear();
+    tables_built = 0;
+    tables_reused = 0;
+    reassignment_subsets = 0;
+    bytes_allocated = 0;
+    has_hardware_counters = false;
+}
+
+void recap::solve_statistics::merge(const solve_statistics& other)
+{
+    for (auto item : other.layers)
+    {
+        item.table += tables_built;
+        layers.push_back(item);
+    }
+    tables_built += other.tables_built;
+    tables_reused += other.tables_reused;
+    reassignment_subsets += other.reassignment_subsets;
+    bytes_allocated += other.bytes_allocated;
+    has_hardware_counters = has_hardware_counters || other.has_hardware_counters;
+}
+
+double recap::solve_statistics::total_time_ms() const
+{
+    double result = 0;
+    for (const auto& item : layers)
+    {
+        result += item.time_ms;
+    }
+    return result;
+}
+
+void recap::print_statistics(std::ostream& output, const solve_statistics& stats)
+{
+    // sum layers with the same index over all tables
+    std::vector<layer_statistics> totals;
+    std::vector<std::size_t> table_counts;
+    for (const auto& item : stats.layers)
+    {
+        if (item.layer >= totals.size())
+        {
+            totals.resize(item.layer + 1);
+            table_counts.resize(item.layer + 1, 0);
+        }
+
+        auto& total = totals[item.layer];
+        total.layer = item.layer;
+        total.time_ms += item.time_ms;
+        total.cells += item.cells;
+        total.evaluations += item.evaluations;
+        total.improvements += item.improvements;
+        total.hardware += item.hardware;
+        ++table_counts[item.layer];
+    }
+
+    auto flags = output.flags();
+    auto precision = output.precision();
+
+    output << "Tables built: " << stats.tables_built << ", reused: " << stats.tables_reused << std::endl;
+    output << "Reassignment subsets: " << stats.reassignment_subsets << std::endl;
+    output << "Bytes allocated: " << stats.bytes_allocated << std::endl;
+
+    constexpr int width = 14;
+    output
+        << std::right
+        << std::setw(6) << "layer"
+        << std::setw(8) << "tables"
+        << std::setw(width) << "time ms"
+        << std::setw(width) << "cells"
+        << std::setw(width) << "evaluations"
+        << std::setw(width) << "improvements";
+    if (stats.has_hardware_counters)
+    {
+        output
+            << std::setw(8) << "IPC"
+            << std::setw(10) << "L1D MPKI"
+            << std::setw(10) << "LLC MPKI"
+            << std::setw(10) << "br MPKI";
+    }
+    output << std::endl;
+
+    // print events per 1000 instructions of @p item
+    auto print_hardware = [&](const layer_statistics& item)
+    {
+        if (stats.has_hardware_counters)
+        {
+            const auto& hardware = item.hardware;
+            output
+                << std::setw(8) << std::setprecision(2) << hardware.ipc()
+                << std::setw(10) << hardware.per_kilo_instruction(hardware.l1d_misses)
+                << std::setw(10) << hardware.per_kilo_instruction(hardware.llc_misses)
+                << std::setw(10) << hardware.per_kilo_instruction(hardware.branch_misses)
+                << std::setprecision(3);
+        }
+        output << std::endl;
+    };
+
+    layer_statistics sum;
+    output << std::fixed << std::setprecision(3);
+    for (std::size_t i = 0; i < totals.size(); ++i)
+    {
+        const auto& total = totals[i];
+        output
+            << std::setw(6) << i
+            << std::setw(8) << table_counts[i]
+            << std::setw(width) << total.time_ms
+            << std::setw(width) << total.cells
+            << std::setw(width) << total.evaluations
+            << std::setw(width) << total.improvements;
+        print_hardware(total);
+
+        sum.time_ms += total.time_ms;
+        sum.cells += total.cells;
+        sum.evaluations += total.evaluations;
+        sum.improvements += total.improvements;
+        sum.hardware += total.hardware;
+    }
+
+    output
+        << std::setw(6) << "total"
+        << std::setw(8) << stats.tables_built
+        << std::setw(width) << sum.time_ms
+        << std::setw(width) << sum.cells
+        << std::setw(width) << sum.evaluations
+        << std::setw(width) << sum.improvements;
+    print_hardware(sum);
+
+    output.flags(flags);
+    output.precision(precision);
+}
+
+void recap::write_statistics_json(std::ostream& output, const solve_statistics& stats)
+{
+    auto flags = output.flags();
+    auto precision = output.precision();
+
+    output << std::fixed << std::setprecision(3);
+    output << "{" << std::endl;
+    output << "    \"tables_built\": " << stats.tables_built << "," << std::endl;
+    output << "    \"tables_reused\": " << stats.tables_reused << "," << std::endl;
+    output << "    \"reassignment_subsets\": " << stats.reassignment_subsets << "," << std::endl;
+    output << "    \"bytes_allocated\": " << stats.bytes_allocated << "," << std::endl;
+    output << "    \"hardware_counters\": " << (stats.has_hardware_counters ? "true" : "false") << "," << std::endl;
+    output << "    \"layer_time_ms\": " << stats.total_time_ms() << "," << std::endl;
+    output << "    \"layers\": [";
+    for (std::size_t i = 0; i < stats.layers.size(); ++i)
+    {
+        const auto& item = stats.layers[i];
+        output
+            << (i > 0 ? "," : "") << std::endl
+            << "        { \"table\": " << item.table
+            << ", \"layer\": " << item.layer
+            << ", \"time_ms\": " << item.time_ms
+            << ", \"cells\": " << item.cells
+            << ", \"evaluations\": " << item.evaluations
+            << ", \"improvements\": " << item.improvements;
+        if (stats.has_hardware_counters)
+        {
+            output
+                << ", \"cycles\": " << item.hardware.cycles
+                << ", \"instructions\": " << item.hardware.instructions
+                << ", \"l1d_misses\": " << item.hardware.l1d_misses
+                << ", \"llc_misses\": " << item.hardware.llc_misses
+                << ", \"branch_misses\": " << item.hardware.branch_misses;
+        }
+        output << " }";
+    }
+    if (!stats.layers.empty())
+    {
+        output << std::endl << "    ";
+    }
+    output << "]" << std::endl;
+    output << "}" << std::endl;
+
+    output.flags(flags);
+    output.precision(precision);
+}
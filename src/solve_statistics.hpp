@@ -0,0 +1,86 @@
+#ifndef RECAP_SOLVE_STATISTICS_HPP_
+#define RECAP_SOLVE_STATISTICS_HPP_
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <ostream>
+
+#include "perf_counters.hpp"
+
+namespace recap
+{
+    /** Work done in one layer of a dynamic programming table
+     */
+    struct layer_statistics
+    {
+        // Index of the table among all tables built since the statistics have been cleared
+        std::size_t table = 0;
+        // Index of the layer in the table
+        std::size_t layer = 0;
+        // Wall time between the start of the first and the end of the last computation in
+        // this layer (layers can overlap)
+        double time_ms = 0;
+        // Number of computed cells
+        std::uint64_t cells = 0;
+        // Number of cells relaxed by a recipe summed over all recipes (cells skipped by
+        // pruning are not counted)
+        std::uint64_t evaluations = 0;
+        // Number of evaluations which lowered the cost of a cell
+        std::uint64_t improvements = 0;
+        // Hardware events of all threads which computed this layer (0 unless 
+        // solve_statistics::has_hardware_counters is set)
+        hardware_counters hardware;
+    };
+
+    /** Work done by an assignment algorithm since the statistics have been cleared
+     */
+    struct solve_statistics
+    {
+        // Statistics of each computed layer of all tables
+        std::vector<layer_statistics> layers;
+        // Number of computed tables
+        std::size_t tables_built = 0;
+        // Number of queries answered from an existing table (cached in memory or stored in a file)
+        std::size_t tables_reused = 0;
+        // Number of subsets of recrafted slots solved separately (a reassignment solved
+        // in one pass counts as one subset)
+        std::size_t reassignment_subsets = 0;
+        // Number of bytes of tables and buffers allocated by the algorithm
+        std::size_t bytes_allocated = 0;
+        // True iff hardware counters of layers have been captured
+        bool has_hardware_counters = false;
+
+        /** Reset all counters
+         */
+        void clear();
+
+        /** Add statistics of @p other (its tables are numbered after tables of this object)
+         *
+         * @param other Statistics of another computation
+         */
+        void merge(const solve_statistics& other);
+
+        /** Sum of wall times of all layers (overlapping layers are counted twice)
+         *
+         * @returns time in milliseconds
+         */
+        double total_time_ms() const;
+    };
+
+    /** Print @p stats in a human readable way (layers with the same index are summed over tables)
+     *
+     * @param output Output stream
+     * @param stats Statistics
+     */
+    void print_statistics(std::ostream& output, const solve_statistics& stats);
+
+    /** Write @p stats as a JSON object
+     *
+     * @param output Output stream
+     * @param stats Statistics
+     */
+    void write_statistics_json(std::ostream& output, const solve_statistics& stats);
+}
+
+#endif // RECAP_SOLVE_STATISTICS_HPP_
@@ -0,0 +1,418 @@
+#include "table_file.hpp"
+#include "mapped_file.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <memory>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include <unistd.h>
+#include <sys/stat.h>
+
+namespace
+{
+    using recap::solution_table;
+
+    // Magic bytes at the beginning of every table file
+    const char TABLE_FILE_MAGIC[8] = { 'R', 'E', 'C', 'A', 'P', 'T', 'B', 'L' };
+
+    // Value used to detect files written on a machine with a different byte order
+    constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+    // Alignment of the cost and choice tables in the file
+    constexpr std::uint64_t TABLE_ALIGNMENT = 64;
+
+    /** Header of a table file.
+     * 
+     * The header is followed by the slots of each layer (std::uint32_t), recipes 
+     * (recipe_record), the cost table and the choice tables of all layers.
+     */
+    struct table_file_header
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t byte_order;
+        std::uint32_t cost_size;
+        std::uint32_t slot_count;
+        std::uint32_t recipe_count;
+        std::uint16_t max_resistances[4];
+        // cost_precision of the costs (quantized costs are rounded)
+        std::uint32_t precision;
+        std::uint64_t recipes_hash;
+        std::uint64_t value_count;
+        std::uint64_t slots_offset;
+        std::uint64_t recipes_offset;
+        std::uint64_t costs_offset;
+        std::uint64_t choices_offset;
+        std::uint64_t file_size;
+    };
+
+    /** Recipe stored in a table file
+     */
+    struct recipe_record
+    {
+        std::uint16_t resistances[4];
+        recap::recipe::cost_t cost;
+        std::uint32_t slots;
+    };
+
+    static_assert(std::is_trivially_copyable_v<table_file_header>);
+    static_assert(std::is_trivially_copyable_v<recipe_record>);
+    static_assert(sizeof(recipe_record) == 16);
+
+    inline std::uint64_t align(std::uint64_t offset)
+    {
+        return (offset + TABLE_ALIGNMENT - 1) / TABLE_ALIGNMENT * TABLE_ALIGNMENT;
+    }
+
+    inline recipe_record to_record(const recap::recipe& rec)
+    {
+        recipe_record result;
+        result.resistances[0] = rec.resistances().fire();
+        result.resistances[1] = rec.resistances().cold();
+        result.resistances[2] = rec.resistances().lightning();
+        result.resistances[3] = rec.resistances().chaos();
+        result.cost = rec.cost();
+        result.slots = rec.slots();
+        return result;
+    }
+
+    /** Compute offsets of all parts of a table file
+     */
+    table_file_header make_header(
+        recap::resistance max_res, 
+        std::size_t slot_count, 
+        const std::vector<recap::recipe>& recipes,
+        recap::cost_precision precision)
+    {
+        table_file_header header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, TABLE_FILE_MAGIC, sizeof(header.magic));
+        header.version = recap::TABLE_FILE_VERSION;
+        header.byte_order = BYTE_ORDER_MARK;
+        header.cost_size = sizeof(solution_table::cost_t);
+        header.slot_count = static_cast<std::uint32_t>(slot_count);
+        header.recipe_count = static_cast<std::uint32_t>(recipes.size());
+        header.max_resistances[0] = max_res.fire();
+        header.max_resistances[1] = max_res.cold();
+        header.max_resistances[2] = max_res.lightning();
+        header.max_resistances[3] = max_res.chaos();
+        header.precision = static_cast<std::uint32_t>(precision);
+
+        header.recipes_hash = recap::hash_recipes(recipes);
+        header.value_count = static_cast<std::uint64_t>(max_res.fire() + 1) *
+            (max_res.cold() + 1) *
+            (max_res.lightning() + 1) *
+            (max_res.chaos() + 1);
+        header.slots_offset = sizeof(table_file_header);
+        header.recipes_offset = header.slots_offset + header.slot_count * sizeof(std::uint32_t);
+        header.costs_offset = align(header.recipes_offset + header.recipe_count * sizeof(recipe_record));
+        header.choices_offset = align(header.costs_offset + header.value_count * sizeof(solution_table::cost_t));
+        header.file_size = header.choices_offset + 
+            header.value_count * header.slot_count * sizeof(solution_table::recipe_index_t);
+        return header;
+    }
+
+    /** Suffix of names of table files with costs of @p precision
+     */
+    inline const char* precision_suffix(recap::cost_precision precision)
+    {
+        return precision == recap::cost_precision::quantized ? ".quantized.table" : ".table";
+    }
+
+    /** Write zero bytes to @p output until its position is @p offset
+     */
+    void pad(std::ofstream& output, std::uint64_t offset)
+    {
+        const char zero[TABLE_ALIGNMENT] = {};
+        auto position = static_cast<std::uint64_t>(output.tellp());
+        if (position < offset)
+        {
+            output.write(zero, offset - position);
+        }
+    }
+}
+
+std::string recap::table_file_name(
+    std::uint64_t recipes_hash, 
+    std::uint64_t slots_hash, 
+    resistance max_resistances,
+    cost_precision precision)
+{
+    std::stringstream name;
+    name << std::hex << std::setfill('0')
+        << std::setw(16) << recipes_hash << "-"
+        << std::setw(16) << slots_hash << "-"
+        << std::dec
+        << max_resistances.fire() << "x"
+        << max_resistances.cold() << "x"
+        << max_resistances.lightning() << "x"
+        << max_resistances.chaos() << precision_suffix(precision);
+    return name.str();
+}
+
+bool recap::parse_table_file_name(
+    const std::string& name,
+    std::uint64_t& recipes_hash, 
+    std::uint64_t& slots_hash, 
+    resistance& max_resistances,
+    cost_precision& precision)
+{
+    unsigned long long recipes_value, slots_value;
+    unsigned fire, cold, lightning, chaos;
+    int length = 0;
+    auto count = std::sscanf(
+        name.c_str(), 
+        "%16llx-%16llx-%ux%ux%ux%u%n", 
+        &recipes_value, 
+        &slots_value, 
+        &fire, 
+        &cold, 
+        &lightning, 
+        &chaos,
+        &length);
+    if (count != 6)
+    {
+        return false;
+    }
+
+    auto suffix = name.substr(static_cast<std::size_t>(length));
+    cost_precision name_precision;
+    if (suffix == precision_suffix(cost_precision::exact))
+    {
+        name_precision = cost_precision::exact;
+    }
+    else if (suffix == precision_suffix(cost_precision::quantized))
+    {
+        name_precision = cost_precision::quantized;
+    }
+    else 
+    {
+        return false;
+    }
+
+    // make sure the name is canonical
+    auto max_res = resistance{ 
+        static_cast<resistance::item_t>(fire), 
+        static_cast<resistance::item_t>(cold), 
+        static_cast<resistance::item_t>(lightning), 
+        static_cast<resistance::item_t>(chaos) 
+    };
+    if (table_file_name(recipes_value, slots_value, max_res, name_precision) != name)
+    {
+        return false;
+    }
+
+    recipes_hash = recipes_value;
+    slots_hash = slots_value;
+    max_resistances = max_res;
+    precision = name_precision;
+    return true;
+}
+
+void recap::write_table_file(
+    const std::string& path, 
+    const solution_table& table, 
+    const std::vector<recipe>& recipes,
+    cost_precision precision)
+{
+    auto header = make_header(table.max_resistances(), table.layer_count(), recipes, precision);
+
+    // each writer has its own temporary file in the target directory (several processes 
+    // can store the same table at the same time)
+    std::vector<char> temp_name{ path.begin(), path.end() };
+    for (auto c : std::string{ ".XXXXXX" })
+    {
+        temp_name.push_back(c);
+    }
+    temp_name.push_back('\0');
+
+    auto fd = ::mkstemp(temp_name.data());
+    if (fd < 0)
+    {
+        throw std::runtime_error{ "Can't create a temporary file for " + path + ": " + std::strerror(errno) };
+    }
+
+    // mkstemp() only allows the owner to read the file
+    ::fchmod(fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    ::close(fd);
+    std::string temp_path{ temp_name.data() };
+
+    {
+        std::ofstream output{ temp_path, std::ios::binary | std::ios::trunc };
+        if (!output)
+        {
+            std::remove(temp_path.c_str());
+            throw std::runtime_error{ "Can't create " + temp_path };
+        }
+
+        output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        for (auto slot : table.slots())
+        {
+            std::uint32_t value = slot;
+            output.write(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+
+        for (auto& rec : recipes)
+        {
+            auto record = to_record(rec);
+            output.write(reinterpret_cast<const char*>(&record), sizeof(record));
+        }
+
+        // cells are always stored in the dense layout (chaos rows are contiguous in every layout)
+        auto write_cells = [&](const auto* cells)
+        {
+            const auto max_res = table.max_resistances();
+            if (table.layout().kind() == layout_kind::dense)
+            {
+                output.write(reinterpret_cast<const char*>(cells), header.value_count * sizeof(*cells));
+                return;
+            }
+
+            for (std::size_t fire = 0; fire <= max_res.fire(); ++fire)
+            {
+                for (std::size_t cold = 0; cold <= max_res.cold(); ++cold)
+                {
+                    for (std::size_t lightning = 0; lightning <= max_res.lightning(); ++lightning)
+                    {
+                        resistance row{ 
+                            static_cast<resistance::item_t>(fire), 
+                            static_cast<resistance::item_t>(cold), 
+                            static_cast<resistance::item_t>(lightning), 
+                            0 
+                        };
+                        output.write(
+                            reinterpret_cast<const char*>(cells + table.to_index(row)), 
+                            (max_res.chaos() + 1) * sizeof(*cells));
+                    }
+                }
+            }
+        };
+
+        pad(output, header.costs_offset);
+        write_cells(table.costs());
+
+        pad(output, header.choices_offset);
+        for (std::size_t i = 0; i < table.layer_count(); ++i)
+        {
+            write_cells(table.choices(i));
+        }
+
+        output.flush();
+        if (!output)
+        {
+            output.close();
+            std::remove(temp_path.c_str());
+            throw std::runtime_error{ "Can't write " + temp_path };
+        }
+    }
+
+    // the rename is atomic so readers see either no file or a complete file
+    if (std::rename(temp_path.c_str(), path.c_str()) != 0)
+    {
+        std::remove(temp_path.c_str());
+
+        // another writer has already stored the same table
+        struct stat info;
+        if (::stat(path.c_str(), &info) == 0)
+        {
+            return;
+        }
+        throw std::runtime_error{ "Can't rename " + temp_path + " to " + path };
+    }
+}
+
+bool recap::map_table_file(
+    const std::string& path, 
+    const std::vector<recipe>& recipes, 
+    cost_precision precision,
+    solution_table& table)
+{
+    auto file = std::make_shared<mapped_file>(path);
+    if (file->size() < sizeof(table_file_header))
+    {
+        return false;
+    }
+
+    table_file_header header;
+    std::memcpy(&header, file->data(), sizeof(header));
+    if (std::memcmp(header.magic, TABLE_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != TABLE_FILE_VERSION ||
+        header.byte_order != BYTE_ORDER_MARK ||
+        header.cost_size != sizeof(solution_table::cost_t) ||
+        header.file_size != file->size())
+    {
+        return false;
+    }
+
+    // rounded costs can't be used by an exact algorithm
+    if (header.precision != static_cast<std::uint32_t>(precision))
+    {
+        return false;
+    }
+
+    // check that the table was computed for the same recipes
+    if (header.recipe_count != recipes.size() ||
+        header.recipes_hash != hash_recipes(recipes))
+    {
+        return false;
+    }
+
+    resistance max_res{ 
+        header.max_resistances[0], 
+        header.max_resistances[1], 
+        header.max_resistances[2], 
+        header.max_resistances[3] 
+    };
+    
+    // check that all parts of the file are where they should be
+    auto expected = make_header(max_res, header.slot_count, recipes, precision);
+    if (header.value_count != expected.value_count ||
+        header.slots_offset != expected.slots_offset ||
+        header.recipes_offset != expected.recipes_offset ||
+        header.costs_offset != expected.costs_offset ||
+        header.choices_offset != expected.choices_offset ||
+        header.file_size != expected.file_size)
+    {
+        return false;
+    }
+
+    for (std::size_t i = 0; i < recipes.size(); ++i)
+    {
+        recipe_record record;
+        std::memcpy(
+            &record, 
+            file->data() + header.recipes_offset + i * sizeof(recipe_record), 
+            sizeof(record));
+        
+        auto stored = recipe{ 
+            resistance{ record.resistances[0], record.resistances[1], record.resistances[2], record.resistances[3] },
+            record.cost,
+            static_cast<recipe::slot_t>(record.slots)
+        };
+        if (stored != recipes[i])
+        {
+            return false;
+        }
+    }
+
+    std::vector<recipe::slot_t> slots(header.slot_count);
+    for (std::size_t i = 0; i < slots.size(); ++i)
+    {
+        std::uint32_t value;
+        std::memcpy(&value, file->data() + header.slots_offset + i * sizeof(value), sizeof(value));
+        slots[i] = static_cast<recipe::slot_t>(value);
+    }
+
+    auto costs = reinterpret_cast<const solution_table::cost_t*>(file->data() + header.costs_offset);
+    auto choices = reinterpret_cast<const solution_table::recipe_index_t*>(file->data() + header.choices_offset);
+    table = solution_table{ max_res, slots, std::move(file), costs, choices };
+    return true;
+}
\ No newline at end of file
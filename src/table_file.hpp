@@ -0,0 +1,93 @@
+#ifndef RECAP_TABLE_FILE_HPP_
+#define RECAP_TABLE_FILE_HPP_
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include "recipe.hpp"
+#include "resistance.hpp"
+#include "solution_table.hpp"
+
+namespace recap
+{
+    // Version of the table file format (increment it whenever the layout changes)
+    inline constexpr std::uint32_t TABLE_FILE_VERSION = 2;
+
+    /** Get name of a file with a table.
+     * 
+     * The name identifies the problem (recipes and the multiset of slots), the 
+     * dimensions of the table and the precision of its costs so that a matching 
+     * file can be found without opening it.
+     * 
+     * @param recipes_hash hash_recipes() of recipes used to compute the table
+     * @param slots_hash hash_slots() of sorted slots used to compute the table
+     * @param max_resistances Dimensions of the table
+     * @param precision Precision of costs used to compute the table
+     * 
+     * @returns file name (without directory)
+     */
+    std::string table_file_name(
+        std::uint64_t recipes_hash, 
+        std::uint64_t slots_hash, 
+        resistance max_resistances,
+        cost_precision precision);
+
+    /** Parse a name created by table_file_name()
+     * 
+     * @param name File name (without directory)
+     * @param recipes_hash Parsed hash of recipes
+     * @param slots_hash Parsed hash of sorted slots
+     * @param max_resistances Parsed dimensions of the table
+     * @param precision Parsed precision of costs
+     * 
+     * @returns true iff @p name is a name of a table file
+     */
+    bool parse_table_file_name(
+        const std::string& name,
+        std::uint64_t& recipes_hash, 
+        std::uint64_t& slots_hash, 
+        resistance& max_resistances,
+        cost_precision& precision);
+
+    /** Store @p table to a file.
+     * 
+     * The file is written to a unique temporary file first and renamed afterwards so that 
+     * other processes never see a partially written table. Several processes can store 
+     * the same table at the same time (the file of one of them is kept).
+     * 
+     * @param path Path to the file
+     * @param table Computed table
+     * @param recipes Recipes used to compute @p table
+     * @param precision Precision of costs used to compute @p table (quantized costs are rounded)
+     * 
+     * @throws std::runtime_error if the file can't be written
+     */
+    void write_table_file(
+        const std::string& path, 
+        const solution_table& table, 
+        const std::vector<recipe>& recipes,
+        cost_precision precision);
+
+    /** Map a file created by write_table_file() to memory.
+     * 
+     * The table in @p table is a read-only view of the mapped file (nothing is copied).
+     * 
+     * @param path Path to the file
+     * @param recipes Recipes which have to be stored in the file
+     * @param precision Precision of costs which has to be stored in the file
+     * @param table Loaded table (unchanged if the file is not valid)
+     * 
+     * @returns false if the file is not a valid table of @p recipes (wrong version,
+     *          corrupted file, different recipes or costs of a different precision)
+     * 
+     * @throws std::runtime_error if the file can't be opened or mapped
+     */
+    bool map_table_file(
+        const std::string& path, 
+        const std::vector<recipe>& recipes, 
+        cost_precision precision,
+        solution_table& table);
+}
+
+#endif // RECAP_TABLE_FILE_HPP_
\ No newline at end of file
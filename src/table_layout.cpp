@@ -0,0 +1,88 @@
+#include "table_layout.hpp"
+
+namespace
+{
+    /** Round @p value up to a power of two
+     */
+    std::size_t round_up_pow2(std::size_t value)
+    {
+        std::size_t result = 1;
+        while (result < value)
+        {
+            result *= 2;
+        }
+        return result;
+    }
+
+    // Morton order of values inside a tile interleaves 2 bits of fire and cold values
+    static_assert(recap::table_layout::TILE_SIZE == 4);
+
+    /** Mapping of a resistance type which is not tiled
+     */
+    recap::table_layout::dimension make_linear(std::size_t stride)
+    {
+        return recap::table_layout::dimension{ 0, 0, stride, {} };
+    }
+}
+
+recap::table_layout::table_layout() :
+    kind_(layout_kind::dense),
+    size_(0),
+    dims_{ make_linear(0), make_linear(0), make_linear(0), make_linear(0) }
+{
+}
+
+recap::table_layout::table_layout(layout_kind kind, resistance max_resistances) :
+    kind_(kind),
+    size_(0)
+{
+    std::array<std::size_t, 4> extent{
+        std::size_t{ max_resistances.fire() } + 1,
+        std::size_t{ max_resistances.cold() } + 1,
+        std::size_t{ max_resistances.lightning() } + 1,
+        std::size_t{ max_resistances.chaos() } + 1
+    };
+
+    // rows of the last resistance type have to stay contiguous
+    if (kind_ == layout_kind::tiled && extent[2] == 1 && extent[3] == 1)
+    {
+        kind_ = layout_kind::padded;
+    }
+
+    // number of values of each resistance type in memory
+    auto allocated = extent;
+    if (kind_ != layout_kind::dense)
+    {
+        for (std::size_t k = 1; k < 4; ++k)
+        {
+            allocated[k] = round_up_pow2(extent[k]);
+        }
+    }
+
+    dims_[3] = make_linear(1);
+    dims_[2] = make_linear(allocated[3]);
+    if (kind_ != layout_kind::tiled)
+    {
+        dims_[1] = make_linear(dims_[2].stride * allocated[2]);
+        dims_[0] = make_linear(dims_[1].stride * allocated[1]);
+        size_ = dims_[0].stride * extent[0];
+        return;
+    }
+
+    // a tile contains TILE_SIZE x TILE_SIZE planes of lightning and chaos resistances
+    const std::size_t plane = dims_[2].stride * allocated[2];
+    const std::size_t tile = plane * TILE_SIZE * TILE_SIZE;
+    const std::size_t tile_columns = (extent[1] + TILE_SIZE - 1) / TILE_SIZE;
+    const std::size_t tile_rows = (extent[0] + TILE_SIZE - 1) / TILE_SIZE;
+
+    dims_[1] = dimension{ 2, TILE_SIZE - 1, tile, {} };
+    dims_[0] = dimension{ 2, TILE_SIZE - 1, tile * tile_columns, {} };
+    for (std::size_t value = 0; value < TILE_SIZE; ++value)
+    {
+        // interleave bits of fire (odd bits) and cold (even bits) values
+        auto spread = (value & 1) | ((value & 2) << 1);
+        dims_[1].inner[value] = spread * plane;
+        dims_[0].inner[value] = (spread << 1) * plane;
+    }
+    size_ = tile * tile_columns * tile_rows;
+}
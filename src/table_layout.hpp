@@ -0,0 +1,133 @@
+#ifndef RECAP_TABLE_LAYOUT_HPP_
+#define RECAP_TABLE_LAYOUT_HPP_
+
+#include <array>
+#include <cstddef>
+
+#include "resistance.hpp"
+
+namespace recap
+{
+    /** Order of table cells in memory
+     */
+    enum class layout_kind
+    {
+        // row-major order without gaps
+        dense,
+        // row-major order with the number of values of all but the first dimension
+        // rounded up to a power of two
+        padded,
+        // padded rows of lightning and chaos resistances in tiles of TILE_SIZE x TILE_SIZE
+        // fire and cold values (in Morton order inside a tile)
+        tiled
+    };
+
+    /** Mapping of resistance values to positions of cells of a table in memory.
+     *
+     * Each resistance type is mapped separately and the position of a cell is the sum of
+     * the offsets of its values. Value x of a resistance type has offset
+     * (x >> shift) * stride + inner[x & mask]. Values of the last resistance type with
+     * more than one value are always contiguous.
+     */
+    class table_layout
+    {
+    public:
+        // Number of values of fire and cold resistances in a tile of the tiled layout
+        inline static constexpr std::size_t TILE_SIZE = 4;
+
+        /** Mapping of values of one resistance type
+         */
+        struct dimension
+        {
+            std::size_t shift;
+            std::size_t mask;
+            std::size_t stride;
+            // offsets of values inside a tile
+            std::array<std::size_t, TILE_SIZE> inner;
+
+            /** Offset of value @p value in the table
+             *
+             * @param value Resistance value
+             *
+             * @returns offset of the value
+             */
+            inline std::size_t offset(std::size_t value) const
+            {
+                return (value >> shift) * stride + inner[value & mask];
+            }
+        };
+
+        /** Create layout of an empty table
+         */
+        table_layout();
+
+        /** Create layout of a table with all resistance values <= @p max_resistances
+         *
+         * The tiled layout falls back to the padded layout if the table has only one
+         * value of lightning and chaos resistances (cold resistances have to be contiguous).
+         *
+         * @param kind Order of cells in memory
+         * @param max_resistances Maximal resistances in the table
+         */
+        table_layout(layout_kind kind, resistance max_resistances);
+
+        /** Order of cells in memory
+         *
+         * @returns kind of this layout
+         */
+        inline layout_kind kind() const
+        {
+            return kind_;
+        }
+
+        /** Number of cells in memory (including gaps)
+         *
+         * @returns size of the table
+         */
+        inline std::size_t size() const
+        {
+            return size_;
+        }
+
+        /** Check whether position of resistances x - y is position of x minus position of y
+         *
+         * @returns true iff the layout is not tiled
+         */
+        inline bool is_linear() const
+        {
+            return kind_ != layout_kind::tiled;
+        }
+
+        /** Mapping of one resistance type
+         *
+         * @param index Index of the resistance type (fire, cold, lightning, chaos)
+         *
+         * @returns mapping of the values
+         */
+        inline const dimension& dim(std::size_t index) const
+        {
+            return dims_[index];
+        }
+
+        /** Find position of a cell in memory
+         *
+         * @param res Resistances (<= maximal resistances of the layout)
+         *
+         * @returns index of the cell
+         */
+        inline std::size_t index(resistance res) const
+        {
+            return dims_[0].offset(res.fire()) +
+                dims_[1].offset(res.cold()) +
+                dims_[2].offset(res.lightning()) +
+                dims_[3].offset(res.chaos());
+        }
+
+    private:
+        layout_kind kind_;
+        std::size_t size_;
+        std::array<dimension, 4> dims_;
+    };
+}
+
+#endif // RECAP_TABLE_LAYOUT_HPP_
@@ -0,0 +1,178 @@
+#include "trace.hpp"
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <iomanip>
+
+namespace
+{
+    using recap::trace::clock;
+
+    /** Recorded span
+     */
+    struct event
+    {
+        const char* name;
+        const char* category;
+        clock::time_point begin;
+        clock::time_point end;
+        // integer argument (ignored if arg_name is nullptr)
+        const char* arg_name;
+        std::int64_t arg_value;
+        // identifier of an async span (ignored if is_async is false)
+        std::int64_t async_id;
+        bool is_async;
+    };
+
+    /** Spans recorded by one thread
+     */
+    struct thread_buffer
+    {
+        // thread ID in the trace (0 is the thread which called start())
+        std::size_t tid;
+        std::vector<event> events;
+    };
+
+    // guards the list of buffers (buffers are only accessed by their threads between start() and write_json())
+    std::mutex buffers_mutex;
+    // buffers of all threads which have recorded a span (they live until the end of the process)
+    std::vector<std::unique_ptr<thread_buffer>> buffers;
+    // buffer of the calling thread
+    thread_local thread_buffer* local_buffer = nullptr;
+    // timestamps in the trace are relative to this time point
+    clock::time_point origin;
+
+    /** Get buffer of the calling thread (it is created by the first call on each thread)
+     */
+    thread_buffer& get_local_buffer()
+    {
+        if (local_buffer == nullptr)
+        {
+            std::lock_guard<std::mutex> lock{ buffers_mutex };
+            buffers.push_back(std::make_unique<thread_buffer>());
+            buffers.back()->tid = buffers.size() - 1;
+            local_buffer = buffers.back().get();
+        }
+        return *local_buffer;
+    }
+
+    /** Number of microseconds between the start of the trace and @p time
+     */
+    double to_timestamp(clock::time_point time)
+    {
+        return std::chrono::duration<double, std::micro>{ time - origin }.count();
+    }
+}
+
+std::atomic<bool> recap::trace::detail::enabled{ false };
+
+void recap::trace::start()
+{
+    // the calling thread is the first thread of the trace
+    get_local_buffer();
+
+    std::lock_guard<std::mutex> lock{ buffers_mutex };
+    for (auto& buffer : buffers)
+    {
+        buffer->events.clear();
+    }
+    origin = clock::now();
+    detail::enabled = true;
+}
+
+void recap::trace::stop()
+{
+    detail::enabled = false;
+}
+
+void recap::trace::record(
+    const char* name,
+    const char* category,
+    clock::time_point begin,
+    clock::time_point end,
+    const char* arg_name,
+    std::int64_t arg_value)
+{
+    get_local_buffer().events.push_back(event{ name, category, begin, end, arg_name, arg_value, 0, false });
+}
+
+void recap::trace::record_async(
+    const char* name,
+    const char* category,
+    std::int64_t id,
+    clock::time_point begin,
+    clock::time_point end)
+{
+    get_local_buffer().events.push_back(event{ name, category, begin, end, nullptr, 0, id, true });
+}
+
+void recap::trace::write_json(std::ostream& output)
+{
+    std::lock_guard<std::mutex> lock{ buffers_mutex };
+
+    auto flags = output.flags();
+    auto precision = output.precision();
+    output << std::fixed << std::setprecision(3);
+
+    output << "{" << std::endl;
+    output << "    \"displayTimeUnit\": \"ms\"," << std::endl;
+    output << "    \"traceEvents\": [";
+
+    bool is_first = true;
+    auto separate = [&]()
+    {
+        output << (is_first ? "" : ",") << std::endl << "        ";
+        is_first = false;
+    };
+
+    for (const auto& buffer : buffers)
+    {
+        // name threads so the thread which started the trace is easy to find
+        separate();
+        output
+            << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << buffer->tid
+            << ", \"args\": {\"name\": \"" << (buffer->tid == 0 ? "main" : "worker ");
+        if (buffer->tid != 0)
+        {
+            output << buffer->tid;
+        }
+        output << "\"}}";
+
+        for (const auto& item : buffer->events)
+        {
+            separate();
+            if (item.is_async)
+            {
+                // async spans are pairs of begin and end events
+                output
+                    << "{\"name\": \"" << item.name << "\", \"cat\": \"" << item.category
+                    << "\", \"ph\": \"b\", \"id\": \"" << item.async_id
+                    << "\", \"ts\": " << to_timestamp(item.begin)
+                    << ", \"pid\": 1, \"tid\": " << buffer->tid << "}," << std::endl
+                    << "        {\"name\": \"" << item.name << "\", \"cat\": \"" << item.category
+                    << "\", \"ph\": \"e\", \"id\": \"" << item.async_id
+                    << "\", \"ts\": " << to_timestamp(item.end)
+                    << ", \"pid\": 1, \"tid\": " << buffer->tid << "}";
+                continue;
+            }
+
+            output
+                << "{\"name\": \"" << item.name << "\", \"cat\": \"" << item.category
+                << "\", \"ph\": \"X\", \"ts\": " << to_timestamp(item.begin)
+                << ", \"dur\": " << to_timestamp(item.end) - to_timestamp(item.begin)
+                << ", \"pid\": 1, \"tid\": " << buffer->tid;
+            if (item.arg_name != nullptr)
+            {
+                output << ", \"args\": {\"" << item.arg_name << "\": " << item.arg_value << "}";
+            }
+            output << "}";
+        }
+    }
+
+    output << std::endl << "    ]" << std::endl;
+    output << "}" << std::endl;
+
+    output.flags(flags);
+    output.precision(precision);
+}
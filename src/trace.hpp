@@ -0,0 +1,139 @@
+#ifndef RECAP_TRACE_HPP_
+#define RECAP_TRACE_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+namespace recap
+{
+    /** Opt-in recording of a timeline of spans which can be written in the Chrome trace event
+     * format (it can be opened in Perfetto or chrome://tracing).
+     *
+     * Spans are recorded by all threads of the process into per-thread buffers. Nothing is
+     * recorded until start() is called, a span then only costs a check of an atomic flag.
+     */
+    namespace trace
+    {
+        using clock = std::chrono::steady_clock;
+
+        namespace detail
+        {
+            // true iff spans are recorded
+            extern std::atomic<bool> enabled;
+        }
+
+        /** Check whether spans are recorded
+         *
+         * @returns true iff start() has been called and stop() has not been called since then
+         */
+        inline bool is_enabled()
+        {
+            return detail::enabled.load(std::memory_order_relaxed);
+        }
+
+        /** Remove all recorded spans and start recording new spans
+         *
+         * It must not be called while other threads record spans.
+         */
+        void start();
+
+        /** Stop recording spans (recorded spans are kept)
+         */
+        void stop();
+
+        /** Record a span which started at @p begin and ended at @p end on the calling thread
+         *
+         * @param name Name of the span (it has to be a string literal)
+         * @param category Category of the span (it has to be a string literal)
+         * @param begin Start of the span
+         * @param end End of the span
+         * @param arg_name Name of an integer argument of the span or nullptr
+         * @param arg_value Value of the argument
+         */
+        void record(
+            const char* name,
+            const char* category,
+            clock::time_point begin,
+            clock::time_point end,
+            const char* arg_name = nullptr,
+            std::int64_t arg_value = 0);
+
+        /** Record a span which can overlap other spans (it is shown on its own track with
+         * the other spans with the same @p name)
+         *
+         * @param name Name of the span (it has to be a string literal)
+         * @param category Category of the span (it has to be a string literal)
+         * @param id Identifier which distinguishes overlapping spans with the same @p name
+         * @param begin Start of the span
+         * @param end End of the span
+         */
+        void record_async(
+            const char* name,
+            const char* category,
+            std::int64_t id,
+            clock::time_point begin,
+            clock::time_point end);
+
+        /** Write all recorded spans as a Chrome trace event JSON object
+         *
+         * It must not be called while other threads record spans.
+         *
+         * @param output Output stream
+         */
+        void write_json(std::ostream& output);
+
+        /** Span which lasts from its construction to its destruction (RAII)
+         */
+        class span
+        {
+        public:
+            /** Start a span on the calling thread if spans are recorded
+             *
+             * @param name Name of the span (it has to be a string literal)
+             * @param category Category of the span (it has to be a string literal)
+             * @param arg_name Name of an integer argument of the span or nullptr
+             * @param arg_value Value of the argument
+             */
+            inline span(const char* name, const char* category, const char* arg_name = nullptr, std::int64_t arg_value = 0) :
+                name_(name),
+                category_(category),
+                arg_name_(arg_name),
+                arg_value_(arg_value),
+                is_recorded_(is_enabled())
+            {
+                if (is_recorded_)
+                {
+                    begin_ = clock::now();
+                }
+            }
+
+            inline ~span()
+            {
+                if (is_recorded_)
+                {
+                    record(name_, category_, begin_, clock::now(), arg_name_, arg_value_);
+                }
+            }
+
+            // Non-copyable
+            span(const span&) = delete;
+            span& operator=(const span&) = delete;
+
+            // Non-movable
+            span(span&&) = delete;
+            span& operator=(span&&) = delete;
+
+        private:
+            const char* name_;
+            const char* category_;
+            const char* arg_name_;
+            std::int64_t arg_value_;
+            bool is_recorded_;
+            clock::time_point begin_;
+        };
+    }
+}
+
+#endif // RECAP_TRACE_HPP_
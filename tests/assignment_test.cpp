@@ -1,7 +1,13 @@
 #include "catch_amalgamated.hpp"
 #include "assignment.hpp"
 #include "parallel_assignment.hpp"
+#include "split_assignment.hpp"
+#include "gather_assignment.hpp"
 #include "cuda_assignment.hpp"
+#include "trace.hpp"
+#include "test_helpers.hpp"
+
+#include <sstream>
 
 // Brute force solution
 static recap::assignment find_assignment_bf(
@@ -57,37 +63,6 @@ static recap::assignment find_assignment_bf(
     return best;
 }
 
-// Verify assignment
-static void verify_assignment(
-    recap::resistance req, 
-    const std::vector<recap::recipe::slot_t>& slots, 
-    const recap::assignment& assign)
-{
-    if (assign.cost() >= recap::recipe::MAX_COST)
-    {
-        return; // no solution is a valid answer
-    }
-
-    REQUIRE(assign.assignments().size() <= slots.size());
-
-    std::size_t used_slots = 0;
-    recap::resistance total_res = recap::resistance::make_zero();
-    recap::recipe::cost_t cost = 0;
-    for (std::size_t i = 0; i < assign.assignments().size(); ++i)
-    {
-        const auto& item = assign.assignments()[i];
-        cost += item.used_recipe().cost();
-        total_res = total_res + item.used_recipe().resistances();
-
-        REQUIRE((used_slots & item.slot()) == 0);
-        used_slots |= item.slot();
-    }
-
-    // check that assignment doesn't lie about its cost
-    REQUIRE(cost == assign.cost());
-    REQUIRE(total_res >= req);
-}
-
 TEST_CASE("Assignment fails if there are no recipes", "[assignment]")
 {
     using namespace recap;
@@ -105,6 +80,8 @@ TEST_CASE("Assignment fails if there are no recipes", "[assignment]")
     };
 
     run_test(parallel_assignment{});
+    run_test(split_assignment{});
+    run_test(gather_assignment{});
 #ifdef USE_CUDA
     run_test(cuda_assignment{});
 #endif // USE_CUDA
@@ -130,6 +107,8 @@ TEST_CASE("Find assignment if we have 0 requirements", "[assignment]")
     };
 
     run_test(parallel_assignment{});
+    run_test(split_assignment{});
+    run_test(gather_assignment{});
 #ifdef USE_CUDA
     run_test(cuda_assignment{});
 #endif // USE_CUDA
@@ -155,6 +134,8 @@ TEST_CASE("No solution with 1 slot", "[assignment]")
     };
 
     run_test(parallel_assignment{});
+    run_test(split_assignment{});
+    run_test(gather_assignment{});
     
 #ifdef USE_CUDA
     run_test(cuda_assignment{});
@@ -182,6 +163,8 @@ TEST_CASE("Only use recipes aplicable to a given slot", "[assignment]")
     };
 
     run_test(parallel_assignment{});
+    run_test(split_assignment{});
+    run_test(gather_assignment{});
     
 #ifdef USE_CUDA
     run_test(cuda_assignment{});
@@ -226,6 +209,11 @@ TEST_CASE("Returned assignment is optimal", "[assignment]")
     };
 
     run_test(parallel_assignment{});
+    run_test(parallel_assignment{ simd::detect_isa(), layer_update::in_place });
+    run_test(parallel_assignment{ simd::detect_isa(), layer_update::double_buffer, layout_kind::padded });
+    run_test(parallel_assignment{ simd::detect_isa(), layer_update::in_place, layout_kind::tiled });
+    run_test(split_assignment{});
+    run_test(gather_assignment{});
     
 #ifdef USE_CUDA
     run_test(cuda_assignment{});
@@ -270,11 +258,616 @@ TEST_CASE("Different types of slots", "[assignment]")
     };
 
     run_test(parallel_assignment{});
+    run_test(parallel_assignment{ simd::detect_isa(), layer_update::in_place });
+    run_test(split_assignment{});
+    run_test(gather_assignment{});
 #ifdef USE_CUDA
     run_test(cuda_assignment{});
 #endif // USE_CUDA
 }
 
+TEST_CASE("Removing dominated recipes doesn't change the cost", "[assignment]")
+{
+    using namespace recap;
+
+    std::vector<recipe::slot_t> slots{
+        recipe::SLOT_BODY,
+        recipe::SLOT_HELMET,
+        recipe::SLOT_RING1,
+        recipe::SLOT_AMULET
+    };
+
+    std::vector<recipe> recipes{
+        recipe{ resistance{ 0, 0, 0, 0 }, 0, recipe::SLOT_ALL },
+        recipe{ resistance{ 30, 0, 0, 0 }, 30, recipe::SLOT_ALL },
+        recipe{ resistance{ 25, 0, 0, 0 }, 30, recipe::SLOT_ARMOUR },
+        recipe{ resistance{ 0, 30, 0, 0 }, 30, recipe::SLOT_ALL },
+        recipe{ resistance{ 0, 0, 30, 0 }, 30, recipe::SLOT_ALL },
+        recipe{ resistance{ 20, 20, 0, 0 }, 10, recipe::SLOT_ALL },
+        recipe{ resistance{ 20, 20, 0, 0 }, 12, recipe::SLOT_JEWELRY },
+        recipe{ resistance{ 20, 0, 20, 0 }, 10, recipe::SLOT_ALL },
+        recipe{ resistance{ 0, 20, 20, 0 }, 10, recipe::SLOT_ALL },
+        recipe{ resistance{ 10, 10, 10, 0 }, 9, recipe::SLOT_JEWELRY },
+        recipe{ resistance{ 10, 10, 0, 0 }, 9, recipe::SLOT_JEWELRY },
+        recipe{ resistance{ 15, 0, 0, 15 }, 30, recipe::SLOT_JEWELRY },
+        recipe{ resistance{ 0, 15, 0, 15 }, 30, recipe::SLOT_JEWELRY },
+        recipe{ resistance{ 0, 0, 15, 15 }, 30, recipe::SLOT_JEWELRY },
+    };
+    resistance req{ 29, 37, 23, 17 };
+
+    parallel_assignment algorithm;
+    auto expected = algorithm.find_minimal_assignment(req, slots, recipes);
+
+    REQUIRE(remove_dominated_recipes(recipes) == 3);
+
+    auto result = algorithm.find_minimal_assignment(req, slots, recipes);
+    verify_assignment(req, slots, result);
+    REQUIRE(result.cost() == expected.cost());
+}
+
+TEST_CASE("Batch of requirements gives the same assignments as separate queries", "[assignment]")
+{
+    using namespace recap;
+
+    auto run_test = [](auto&& algorithm)
+    {
+        std::vector<recipe::slot_t> slots{
+            recipe::SLOT_BODY,
+            recipe::SLOT_HELMET,
+            recipe::SLOT_RING1,
+            recipe::SLOT_AMULET
+        };
+
+        std::vector<recipe> recipes{
+            recipe{ resistance{ 0, 0, 0, 0 }, 0, recipe::SLOT_ALL },
+            recipe{ resistance{ 30, 0, 0, 0 }, 30, recipe::SLOT_ALL },
+            recipe{ resistance{ 0, 30, 0, 0 }, 30, recipe::SLOT_ALL },
+            recipe{ resistance{ 0, 0, 30, 0 }, 30, recipe::SLOT_ALL },
+            recipe{ resistance{ 20, 20, 0, 0 }, 10, recipe::SLOT_ALL },
+            recipe{ resistance{ 20, 0, 20, 0 }, 10, recipe::SLOT_ALL },
+            recipe{ resistance{ 0, 20, 20, 0 }, 10, recipe::SLOT_ALL },
+            recipe{ resistance{ 10, 10, 10, 0 }, 9, recipe::SLOT_JEWELRY },
+            recipe{ resistance{ 15, 0, 0, 15 }, 30, recipe::SLOT_JEWELRY },
+            recipe{ resistance{ 0, 15, 0, 15 }, 30, recipe::SLOT_JEWELRY },
+            recipe{ resistance{ 0, 0, 15, 15 }, 30, recipe::SLOT_JEWELRY },
+        };
+
+        std::vector<resistance> required{
+            resistance{ 29, 37, 23, 17 },
+            resistance{ 0, 0, 0, 0 },
+            resistance{ 40, 10, 0, 0 },
+            resistance{ 10, 10, 45, 30 },
+            resistance{ 0, 41, 20, 0 },
+            resistance{ 100, 0, 0, 0 },
+        };
+
+        auto results = algorithm.find_minimal_assignments(required, slots, recipes);
+        REQUIRE(results.size() == required.size());
+
+        for (std::size_t i = 0; i < required.size(); ++i)
+        {
+            verify_assignment(required[i], slots, results[i]);
+
+            auto expected = algorithm.find_minimal_assignment(required[i], slots, recipes);
+            REQUIRE(results[i].cost() == expected.cost());
+        }
+    };
+
+    run_test(parallel_assignment{});
+    run_test(parallel_assignment{ simd::detect_isa(), layer_update::in_place });
+    run_test(split_assignment{});
+    run_test(gather_assignment{});
+#ifdef USE_CUDA
+    run_test(cuda_assignment{});
+#endif // USE_CUDA
+}
+
+TEST_CASE("Single query gives the same assignment as a full table", "[assignment]")
+{
+    using namespace recap;
+
+    std::vector<recipe::slot_t> slots{
+        recipe::SLOT_BODY,
+        recipe::SLOT_HELMET,
+        recipe::SLOT_GLOVES,
+        recipe::SLOT_RING1,
+        recipe::SLOT_AMULET
+    };
+
+    std::vector<recipe> recipes{
+        recipe{ resistance{ 0, 0, 0, 0 }, 0, recipe::SLOT_ALL },
+        recipe{ resistance{ 30, 0, 0, 0 }, 30, recipe::SLOT_ALL },
+        recipe{ resistance{ 0, 30, 0, 0 }, 30, recipe::SLOT_ALL },
+        recipe{ resistance{ 0, 0, 30, 0 }, 30, recipe::SLOT_ALL },
+        recipe{ resistance{ 20, 20, 0, 0 }, 10, recipe::SLOT_ARMOUR },
+        recipe{ resistance{ 20, 0, 20, 0 }, 10, recipe::SLOT_ARMOUR },
+        recipe{ resistance{ 0, 20, 20, 0 }, 10, recipe::SLOT_ARMOUR },
+        recipe{ resistance{ 10, 10, 10, 0 }, 9, recipe::SLOT_JEWELRY },
+        recipe{ resistance{ 15, 0, 0, 15 }, 30, recipe::SLOT_JEWELRY },
+        recipe{ resistance{ 0, 15, 0, 15 }, 30, recipe::SLOT_JEWELRY },
+    };
+
+    std::vector<resistance> required{
+        resistance{ 0, 0, 0, 0 },
+        resistance{ 45, 5, 60, 0 },
+        resistance{ 70, 70, 70, 0 },
+        resistance{ 29, 37, 23, 17 },
+        resistance{ 1, 90, 1, 30 },
+    };
+
+    parallel_assignment algorithm;
+    parallel_assignment reference;
+    for (auto req : required)
+    {
+        // only computes the cells needed for the req cell
+        auto result = algorithm.find_minimal_assignment(req, slots, recipes);
+        verify_assignment(req, slots, result);
+
+        auto expected = reference.build_table(req, slots, recipes).find_assignment(req, recipes);
+        REQUIRE(result.cost() == expected.cost());
+    }
+}
+
+TEST_CASE("In-place layer update computes the same table as double buffering", "[assignment]")
+{
+    using namespace recap;
+
+    std::vector<recipe::slot_t> slots{
+        recipe::SLOT_BODY,
+        recipe::SLOT_HELMET,
+        recipe::SLOT_GLOVES,
+        recipe::SLOT_RING1,
+        recipe::SLOT_AMULET
+    };
+
+    std::vector<recipe> recipes{
+        recipe{ resistance{ 0, 0, 0, 0 }, 0, recipe::SLOT_ALL },
+        recipe{ resistance{ 30, 0, 0, 0 }, 30, recipe::SLOT_ALL },
+        recipe{ resistance{ 0, 30, 0, 0 }, 30, recipe::SLOT_ALL },
+        recipe{ resistance{ 0, 0, 30, 0 }, 30, recipe::SLOT_ALL },
+        recipe{ resistance{ 20, 20, 0, 0 }, 10, recipe::SLOT_ARMOUR },
+        recipe{ resistance{ 20, 0, 20, 0 }, 10, recipe::SLOT_ARMOUR },
+        recipe{ resistance{ 0, 20, 20, 0 }, 10, recipe::SLOT_ARMOUR },
+        recipe{ resistance{ 10, 10, 10, 0 }, 9, recipe::SLOT_JEWELRY },
+        recipe{ resistance{ 15, 0, 0, 15 }, 30, recipe::SLOT_JEWELRY },
+        recipe{ resistance{ 0, 15, 0, 15 }, 30, recipe::SLOT_JEWELRY },
+    };
+    resistance max_res{ 50, 45, 40, 20 };
+
+    parallel_assignment reference;
+    parallel_assignment algorithm{ simd::detect_isa(), layer_update::in_place };
+
+    const auto& expected = reference.build_table(max_res, slots, recipes);
+    const auto& result = algorithm.build_table(max_res, slots, recipes);
+    REQUIRE(result.value_count() == expected.value_count());
+    for (std::size_t i = 0; i < result.value_count(); ++i)
+    {
+        REQUIRE(result.costs()[i] == expected.costs()[i]);
+    }
+}
+
+TEST_CASE("All table layouts compute the same costs", "[assignment]")
+{
+    using namespace recap;
+
+    std::vector<recipe::slot_t> slots{
+        recipe::SLOT_BODY,
+        recipe::SLOT_HELMET,
+        recipe::SLOT_GLOVES,
+        recipe::SLOT_RING1,
+        recipe::SLOT_AMULET
+    };
+
+    std::vector<recipe> recipes{
+        recipe{ resistance{ 0, 0, 0, 0 }, 0, recipe::SLOT_ALL },
+        recipe{ resistance{ 30, 0, 0, 0 }, 30, recipe::SLOT_ALL },
+        recipe{ resistance{ 0, 30, 0, 0 }, 30, recipe::SLOT_ALL },
+        recipe{ resistance{ 0, 0, 30, 0 }, 30, recipe::SLOT_ALL },
+        recipe{ resistance{ 20, 20, 0, 0 }, 10, recipe::SLOT_ARMOUR },
+        recipe{ resistance{ 20, 0, 20, 0 }, 10, recipe::SLOT_ARMOUR },
+        recipe{ resistance{ 0, 20, 20, 0 }, 10, recipe::SLOT_ARMOUR },
+        recipe{ resistance{ 10, 10, 10, 0 }, 9, recipe::SLOT_JEWELRY },
+        recipe{ resistance{ 15, 0, 0, 15 }, 30, recipe::SLOT_JEWELRY },
+        recipe{ resistance{ 0, 15, 0, 15 }, 30, recipe::SLOT_JEWELRY },
+    };
+
+    // sizes which are neither multiples of the tile size nor powers of two
+    std::vector<resistance> max_resistances{
+        resistance{ 50, 45, 40, 20 },
+        resistance{ 37, 0, 23, 0 },
+        resistance{ 29, 37, 0, 0 },
+    };
+
+    for (auto max_res : max_resistances)
+    {
+        parallel_assignment reference;
+        const auto& expected = reference.build_table(max_res, slots, recipes);
+
+        for (auto layout : { layout_kind::padded, layout_kind::tiled })
+        {
+            for (auto update : { layer_update::double_buffer, layer_update::in_place })
+            {
+                parallel_assignment algorithm{ simd::detect_isa(), update, layout };
+                const auto& result = algorithm.build_table(max_res, slots, recipes);
+                REQUIRE(result.value_count() >= expected.value_count());
+
+                for (resistance::item_t fire = 0; fire <= max_res.fire(); ++fire)
+                {
+                    for (resistance::item_t cold = 0; cold <= max_res.cold(); ++cold)
+                    {
+                        for (resistance::item_t lightning = 0; lightning <= max_res.lightning(); ++lightning)
+                        {
+                            for (resistance::item_t chaos = 0; chaos <= max_res.chaos(); ++chaos)
+                            {
+                                resistance res{ fire, cold, lightning, chaos };
+                                REQUIRE(result.costs()[result.to_index(res)] == expected.costs()[expected.to_index(res)]);
+                            }
+                        }
+                    }
+                }
+
+                auto expected_cost = expected.find_assignment(max_res, recipes).cost();
+                REQUIRE(result.find_assignment(max_res, recipes).cost() == expected_cost);
+                REQUIRE(algorithm.find_minimal_assignment(max_res, slots, recipes).cost() == expected_cost);
+            }
+        }
+    }
+}
+
+TEST_CASE("Gather algorithm computes the same costs as the parallel algorithm", "[assignment]")
+{
+    using namespace recap;
+
+    std::vector<recipe::slot_t> slots{
+        recipe::SLOT_BODY,
+        recipe::SLOT_HELMET,
+        recipe::SLOT_RING1
+    };
+
+    std::vector<recipe> recipes{
+        recipe{ resistance{ 0, 0, 0, 0 }, 0, recipe::SLOT_ALL },
+        recipe{ resistance{ 30, 0, 0, 0 }, 30, recipe::SLOT_ALL },
+        recipe{ resistance{ 0, 30, 0, 0 }, 30, recipe::SLOT_ALL },
+        recipe{ resistance{ 0, 0, 30, 0 }, 30, recipe::SLOT_ALL },
+        recipe{ resistance{ 20, 20, 0, 0 }, 10, recipe::SLOT_ARMOUR },
+        recipe{ resistance{ 10, 10, 10, 0 }, 9, recipe::SLOT_JEWELRY },
+        recipe{ resistance{ 15, 0, 0, 15 }, 30, recipe::SLOT_JEWELRY },
+    };
+
+    // rows along each resistance type (rows shorter and longer than a tile)
+    std::vector<resistance> max_resistances{
+        resistance{ 50, 45, 40, 20 },
+        resistance{ 37, 0, 23, 0 },
+        resistance{ 29, 7, 0, 0 },
+        resistance{ 45, 0, 0, 0 },
+    };
+
+    for (auto max_res : max_resistances)
+    {
+        parallel_assignment reference;
+        const auto& expected = reference.build_table(max_res, slots, recipes);
+
+        gather_assignment algorithm;
+        const auto& result = algorithm.build_table(max_res, slots, recipes);
+        REQUIRE(result.value_count() == expected.value_count());
+        for (std::size_t k = 0; k < result.value_count(); ++k)
+        {
+            REQUIRE(result.costs()[k] == expected.costs()[k]);
+        }
+    }
+}
+
+TEST_CASE("Solve statistics describe each layer of computed tables", "[assignment]")
+{
+    using namespace recap;
+
+    std::vector<recipe::slot_t> slots{
+        recipe::SLOT_BODY,
+        recipe::SLOT_HELMET,
+        recipe::SLOT_RING1
+    };
+
+    std::vector<recipe> recipes{
+        recipe{ resistance{ 0, 0, 0, 0 }, 0, recipe::SLOT_ALL },
+        recipe{ resistance{ 30, 0, 0, 0 }, 30, recipe::SLOT_ALL },
+        recipe{ resistance{ 0, 30, 0, 0 }, 30, recipe::SLOT_ALL },
+        recipe{ resistance{ 0, 0, 30, 0 }, 30, recipe::SLOT_ALL },
+        recipe{ resistance{ 20, 20, 0, 0 }, 10, recipe::SLOT_ARMOUR },
+        recipe{ resistance{ 10, 10, 10, 0 }, 9, recipe::SLOT_JEWELRY },
+        recipe{ resistance{ 15, 0, 0, 15 }, 30, recipe::SLOT_JEWELRY },
+    };
+
+    resistance max_res{ 50, 45, 40, 20 };
+    auto value_count = assignment_algorithm::count_values(max_res);
+
+    std::vector<std::unique_ptr<assignment_algorithm>> algorithms;
+    algorithms.push_back(std::make_unique<parallel_assignment>());
+    algorithms.push_back(std::make_unique<parallel_assignment>(simd::detect_isa(), layer_update::in_place));
+    algorithms.push_back(std::make_unique<gather_assignment>());
+
+    for (auto& algorithm : algorithms)
+    {
+        // all cells of a full table are computed
+        algorithm->build_table(max_res, slots, recipes);
+        const auto& stats = algorithm->solve_stats();
+        REQUIRE(stats.tables_built == 1);
+        REQUIRE(stats.tables_reused == 0);
+        REQUIRE(stats.reassignment_subsets == 0);
+        REQUIRE(stats.bytes_allocated >= value_count * (sizeof(recipe::cost_t) + slots.size()));
+        REQUIRE(stats.layers.size() == slots.size());
+        for (std::size_t i = 0; i < slots.size(); ++i)
+        {
+            REQUIRE(stats.layers[i].table == 0);
+            REQUIRE(stats.layers[i].layer == i);
+            REQUIRE(stats.layers[i].time_ms >= 0);
+            REQUIRE(stats.layers[i].cells == value_count);
+            REQUIRE(stats.layers[i].improvements > 0);
+            REQUIRE(stats.layers[i].improvements <= stats.layers[i].evaluations);
+            REQUIRE(stats.layers[i].evaluations <= value_count * recipes.size());
+        }
+
+        // statistics accumulate until they are cleared
+        algorithm->find_minimal_assignment(resistance{ 30, 20, 10, 0 }, slots, recipes);
+        REQUIRE(stats.tables_built == 2);
+        REQUIRE(stats.layers.size() == 2 * slots.size());
+        REQUIRE(stats.layers.back().table == 1);
+
+        algorithm->clear_solve_stats();
+        REQUIRE(stats.tables_built == 0);
+        REQUIRE(stats.layers.empty());
+    }
+
+    // memory of a table of the same size is reused
+    parallel_assignment algorithm;
+    algorithm.build_table(max_res, slots, recipes);
+    algorithm.clear_solve_stats();
+    algorithm.build_table(max_res, slots, recipes);
+    REQUIRE(algorithm.solve_stats().bytes_allocated == 0);
+
+    // hardware counters are only captured if the kernel allows to count them
+    parallel_assignment counted;
+    counted.set_hardware_counters(true);
+    REQUIRE(counted.hardware_counters_enabled());
+    const auto& counted_table = counted.build_table(max_res, slots, recipes);
+    const auto& expected_table = algorithm.build_table(max_res, slots, recipes);
+    REQUIRE(std::equal(counted_table.costs(), counted_table.costs() + value_count, expected_table.costs()));
+
+    perf_counters probe;
+    REQUIRE(counted.solve_stats().has_hardware_counters == probe.is_available());
+    REQUIRE(counted.solve_stats().layers.size() == slots.size());
+    for (const auto& layer : counted.solve_stats().layers)
+    {
+        if (probe.is_available())
+        {
+            REQUIRE(layer.hardware.cycles > 0);
+        }
+        else 
+        {
+            REQUIRE(layer.hardware.cycles == 0);
+        }
+    }
+
+    // the split algorithm computes a table for each group of slots
+    split_assignment split;
+    split.find_minimal_assignment(resistance{ 30, 20, 10, 0 }, slots, recipes);
+    REQUIRE(split.solve_stats().tables_built == 2);
+    REQUIRE(split.solve_stats().layers.size() == slots.size());
+}
+
+TEST_CASE("Trace records a span for each block of computed layers", "[assignment]")
+{
+    using namespace recap;
+
+    std::vector<recipe::slot_t> slots{
+        recipe::SLOT_BODY,
+        recipe::SLOT_HELMET,
+        recipe::SLOT_RING1
+    };
+
+    std::vector<recipe> recipes{
+        recipe{ resistance{ 0, 0, 0, 0 }, 0, recipe::SLOT_ALL },
+        recipe{ resistance{ 30, 0, 0, 0 }, 30, recipe::SLOT_ALL },
+        recipe{ resistance{ 0, 30, 0, 0 }, 30, recipe::SLOT_ALL },
+        recipe{ resistance{ 10, 10, 10, 0 }, 9, recipe::SLOT_JEWELRY },
+    };
+
+    resistance max_res{ 50, 45, 40, 20 };
+    parallel_assignment algorithm;
+
+    // nothing is recorded unless the trace is started
+    REQUIRE(!trace::is_enabled());
+    algorithm.build_table(max_res, slots, recipes);
+    std::stringstream empty;
+    trace::write_json(empty);
+    REQUIRE(empty.str().find("\"block\"") == std::string::npos);
+
+    trace::start();
+    REQUIRE(trace::is_enabled());
+    algorithm.build_table(max_res, slots, recipes);
+    trace::stop();
+    REQUIRE(!trace::is_enabled());
+
+    std::stringstream output;
+    trace::write_json(output);
+    auto json = output.str();
+    REQUIRE(json.find("\"traceEvents\"") != std::string::npos);
+    REQUIRE(json.find("\"name\": \"build table\"") != std::string::npos);
+    REQUIRE(json.find("\"name\": \"fill\"") != std::string::npos);
+    REQUIRE(json.find("\"name\": \"block\"") != std::string::npos);
+    for (std::size_t i = 0; i < slots.size(); ++i)
+    {
+        REQUIRE(json.find("\"ph\": \"b\", \"id\": \"" + std::to_string(i) + "\"") != std::string::npos);
+    }
+
+    // starting the trace again removes recorded spans
+    trace::start();
+    trace::stop();
+    std::stringstream restarted;
+    trace::write_json(restarted);
+    REQUIRE(restarted.str().find("\"block\"") == std::string::npos);
+}
+
+TEST_CASE("Quantized costs find assignments within the cost tolerance", "[assignment]")
+{
+    using namespace recap;
+
+    std::vector<recipe::slot_t> slots{
+        recipe::SLOT_BODY,
+        recipe::SLOT_HELMET,
+        recipe::SLOT_GLOVES,
+        recipe::SLOT_RING1,
+        recipe::SLOT_AMULET
+    };
+
+    std::vector<recipe> recipes{
+        recipe{ resistance{ 0, 0, 0, 0 }, 0, recipe::SLOT_ALL },
+        recipe{ resistance{ 30, 0, 0, 0 }, 30, recipe::SLOT_ALL },
+        recipe{ resistance{ 0, 30, 0, 0 }, 30, recipe::SLOT_ALL },
+        recipe{ resistance{ 0, 0, 30, 0 }, 30, recipe::SLOT_ALL },
+        recipe{ resistance{ 20, 20, 0, 0 }, 10, recipe::SLOT_ARMOUR },
+        recipe{ resistance{ 20, 0, 20, 0 }, 10, recipe::SLOT_ARMOUR },
+        recipe{ resistance{ 0, 20, 20, 0 }, 10, recipe::SLOT_ARMOUR },
+        recipe{ resistance{ 10, 10, 10, 0 }, 9, recipe::SLOT_JEWELRY },
+        recipe{ resistance{ 15, 0, 0, 15 }, 30, recipe::SLOT_JEWELRY },
+        recipe{ resistance{ 0, 15, 0, 15 }, 30, recipe::SLOT_JEWELRY },
+    };
+    resistance max_res{ 50, 45, 40, 20 };
+
+    SECTION("Integer costs are exact")
+    {
+        // keep the recipes as they are
+    }
+
+    SECTION("Fractional costs are rounded")
+    {
+        for (std::size_t i = 1; i < recipes.size(); ++i)
+        {
+            recipes[i] = recipe{ recipes[i].resistances(), recipes[i].cost() + 0.1f * i, recipes[i].slots() };
+        }
+    }
+
+    SECTION("Even number of layers")
+    {
+        slots.pop_back();
+    }
+
+    parallel_assignment reference;
+    const auto& expected = reference.build_table(max_res, slots, recipes);
+
+    for (auto update : { layer_update::double_buffer, layer_update::in_place })
+    {
+        parallel_assignment algorithm{ simd::detect_isa(), update, layout_kind::dense, cost_precision::quantized };
+        const auto& result = algorithm.build_table(max_res, slots, recipes);
+        auto tolerance = algorithm.cost_tolerance();
+
+        // quantized layers are stored in the cost table of the result
+        if (update == layer_update::double_buffer)
+        {
+            REQUIRE(algorithm.solve_stats().bytes_allocated == result.size_bytes());
+        }
+
+        for (resistance::item_t fire = 0; fire <= max_res.fire(); fire += 5)
+        {
+            for (resistance::item_t cold = 0; cold <= max_res.cold(); cold += 5)
+            {
+                for (resistance::item_t lightning = 0; lightning <= max_res.lightning(); lightning += 5)
+                {
+                    for (resistance::item_t chaos = 0; chaos <= max_res.chaos(); chaos += 5)
+                    {
+                        resistance res{ fire, cold, lightning, chaos };
+                        auto expected_cost = expected.find_assignment(res, recipes).cost();
+                        auto found = result.find_assignment(res, recipes);
+                        verify_assignment(res, slots, found);
+
+                        if (expected_cost == recipe::MAX_COST)
+                        {
+                            REQUIRE(found.cost() == recipe::MAX_COST);
+                        }
+                        else if (tolerance == 0)
+                        {
+                            REQUIRE(found.cost() == expected_cost);
+                        }
+                        else 
+                        {
+                            REQUIRE(found.cost() >= expected_cost - 1e-3f);
+                            REQUIRE(found.cost() <= expected_cost + tolerance + 1e-3f);
+                        }
+                    }
+                }
+            }
+        }
+
+        auto single = algorithm.find_minimal_assignment(max_res, slots, recipes);
+        verify_assignment(max_res, slots, single);
+        REQUIRE(single.cost() <= expected.find_assignment(max_res, recipes).cost() + tolerance + 1e-3f);
+    }
+}
+
+TEST_CASE("Quantized costs have to be non-negative", "[assignment]")
+{
+    using namespace recap;
+
+    std::vector<recipe::slot_t> slots{ recipe::SLOT_BODY };
+    std::vector<recipe> recipes{ recipe{ resistance{ 10, 0, 0, 0 }, -1, recipe::SLOT_ALL } };
+
+    parallel_assignment algorithm{ simd::detect_isa(), layer_update::double_buffer, layout_kind::dense, cost_precision::quantized };
+    REQUIRE_THROWS_AS(algorithm.build_table(resistance{ 10, 0, 0, 0 }, slots, recipes), std::runtime_error);
+}
+
+TEST_CASE("Requirements with zero resistances give the same cost as a full table", "[assignment]")
+{
+    using namespace recap;
+
+    std::vector<recipe::slot_t> slots{
+        recipe::SLOT_BODY,
+        recipe::SLOT_HELMET,
+        recipe::SLOT_GLOVES,
+        recipe::SLOT_RING1,
+        recipe::SLOT_AMULET
+    };
+
+    std::vector<recipe> recipes{
+        recipe{ resistance{ 0, 0, 0, 0 }, 0, recipe::SLOT_ALL },
+        recipe{ resistance{ 30, 0, 0, 0 }, 30, recipe::SLOT_ALL },
+        recipe{ resistance{ 0, 30, 0, 0 }, 30, recipe::SLOT_ALL },
+        recipe{ resistance{ 0, 0, 30, 0 }, 30, recipe::SLOT_ALL },
+        recipe{ resistance{ 20, 20, 0, 0 }, 10, recipe::SLOT_ARMOUR },
+        recipe{ resistance{ 20, 0, 20, 0 }, 10, recipe::SLOT_ARMOUR },
+        recipe{ resistance{ 0, 20, 20, 0 }, 10, recipe::SLOT_ARMOUR },
+        recipe{ resistance{ 10, 10, 10, 0 }, 9, recipe::SLOT_JEWELRY },
+        recipe{ resistance{ 15, 0, 0, 15 }, 30, recipe::SLOT_JEWELRY },
+        recipe{ resistance{ 0, 15, 0, 15 }, 30, recipe::SLOT_JEWELRY },
+    };
+
+    // each query only has the dimensions with non-zero requirements
+    std::vector<resistance> required{
+        resistance{ 0, 0, 0, 0 },
+        resistance{ 0, 0, 0, 17 },
+        resistance{ 45, 0, 0, 0 },
+        resistance{ 0, 37, 23, 0 },
+        resistance{ 29, 0, 0, 17 },
+        resistance{ 29, 37, 23, 0 },
+        resistance{ 0, 37, 23, 17 },
+    };
+
+    parallel_assignment reference;
+    const auto& table = reference.build_table(resistance{ 50, 50, 50, 20 }, slots, recipes);
+
+    parallel_assignment algorithm;
+    parallel_assignment in_place{ simd::detect_isa(), layer_update::in_place };
+    for (auto req : required)
+    {
+        auto expected = table.find_assignment(req, recipes);
+
+        auto result = algorithm.find_minimal_assignment(req, slots, recipes);
+        verify_assignment(req, slots, result);
+        REQUIRE(result.cost() == expected.cost());
+
+        REQUIRE(algorithm.build_table(req, slots, recipes).find_assignment(req, recipes).cost() == expected.cost());
+        REQUIRE(in_place.build_table(req, slots, recipes).find_assignment(req, recipes).cost() == expected.cost());
+    }
+}
+
 TEST_CASE("Exhaustive test", "[assignment][.][slow]")
 {
     using namespace recap;
@@ -330,6 +923,8 @@ TEST_CASE("Exhaustive test", "[assignment][.][slow]")
         }
     };
     run_test(parallel_assignment{});
+    run_test(split_assignment{});
+    run_test(gather_assignment{});
 #ifdef USE_CUDA
     run_test(cuda_assignment{});
 #endif // USE_CUDA
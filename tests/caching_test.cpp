@@ -0,0 +1,173 @@
+#include "catch_amalgamated.hpp"
+#include "caching_assignment.hpp"
+#include "parallel_assignment.hpp"
+#include "split_assignment.hpp"
+#include "test_helpers.hpp"
+
+// Verify that assignment only uses slots from @p slots and aplicable recipes
+static void verify_slots(
+    const std::vector<recap::recipe::slot_t>& slots, 
+    const recap::assignment& assign)
+{
+    auto free_slots = slots;
+    for (auto& item : assign.assignments())
+    {
+        REQUIRE((item.used_recipe().slots() & item.slot()) != 0);
+
+        auto it = std::find(free_slots.begin(), free_slots.end(), item.slot());
+        REQUIRE(it != free_slots.end());
+        free_slots.erase(it);
+    }
+}
+
+TEST_CASE("Answer queries which fit into a cached table", "[cache]")
+{
+    using namespace recap;
+
+    std::vector<recipe::slot_t> slots{
+        recipe::SLOT_ARMOUR,
+        recipe::SLOT_ARMOUR,
+        recipe::SLOT_JEWELRY,
+    };
+    auto recipes = make_recipes();
+
+    parallel_assignment reference;
+    caching_assignment algorithm{ std::make_unique<parallel_assignment>(), 1 << 24 };
+
+    auto result = algorithm.find_minimal_assignment(resistance{ 40, 40, 20, 10 }, slots, recipes);
+    REQUIRE(algorithm.cache_stats().misses == 1);
+    REQUIRE(algorithm.cache_stats().hits == 0);
+    REQUIRE(algorithm.size() == 1);
+    REQUIRE(result.cost() == reference.find_minimal_assignment(resistance{ 40, 40, 20, 10 }, slots, recipes).cost());
+
+    // smaller requirement
+    result = algorithm.find_minimal_assignment(resistance{ 30, 20, 20, 0 }, slots, recipes);
+    REQUIRE(algorithm.cache_stats().misses == 1);
+    REQUIRE(algorithm.cache_stats().hits == 1);
+    REQUIRE(result.cost() == reference.find_minimal_assignment(resistance{ 30, 20, 20, 0 }, slots, recipes).cost());
+
+    // different order of the same slots
+    std::vector<recipe::slot_t> permuted_slots{
+        recipe::SLOT_JEWELRY,
+        recipe::SLOT_ARMOUR,
+        recipe::SLOT_ARMOUR,
+    };
+    result = algorithm.find_minimal_assignment(resistance{ 40, 25, 10, 10 }, permuted_slots, recipes);
+    REQUIRE(algorithm.cache_stats().hits == 2);
+    REQUIRE(result.cost() == reference.find_minimal_assignment(resistance{ 40, 25, 10, 10 }, permuted_slots, recipes).cost());
+    verify_slots(permuted_slots, result);
+
+    // requirement which doesn't fit into the table replaces it
+    result = algorithm.find_minimal_assignment(resistance{ 50, 40, 20, 10 }, slots, recipes);
+    REQUIRE(algorithm.cache_stats().misses == 2);
+    REQUIRE(algorithm.size() == 1);
+    REQUIRE(result.cost() == reference.find_minimal_assignment(resistance{ 50, 40, 20, 10 }, slots, recipes).cost());
+
+    // different recipes
+    recipes.pop_back();
+    result = algorithm.find_minimal_assignment(resistance{ 30, 20, 20, 0 }, slots, recipes);
+    REQUIRE(algorithm.cache_stats().misses == 3);
+    REQUIRE(algorithm.size() == 2);
+    REQUIRE(algorithm.cache_stats().evictions == 0);
+}
+
+TEST_CASE("Solve statistics include tables computed by the decorated algorithm", "[cache]")
+{
+    using namespace recap;
+
+    std::vector<recipe::slot_t> slots{
+        recipe::SLOT_ARMOUR,
+        recipe::SLOT_ARMOUR,
+        recipe::SLOT_JEWELRY,
+    };
+    auto recipes = make_recipes();
+
+    caching_assignment algorithm{ std::make_unique<parallel_assignment>(), 1 << 24 };
+    algorithm.find_minimal_assignment(resistance{ 40, 40, 20, 10 }, slots, recipes);
+    algorithm.find_minimal_assignment(resistance{ 30, 20, 20, 0 }, slots, recipes);
+
+    const auto& stats = algorithm.solve_stats();
+    REQUIRE(stats.tables_built == 1);
+    REQUIRE(stats.tables_reused == 1);
+    REQUIRE(stats.layers.size() == slots.size());
+    REQUIRE(stats.bytes_allocated >= algorithm.size_bytes());
+}
+
+TEST_CASE("Evict least recently used tables", "[cache]")
+{
+    using namespace recap;
+
+    std::vector<recipe::slot_t> armour_slots{ recipe::SLOT_ARMOUR, recipe::SLOT_ARMOUR };
+    std::vector<recipe::slot_t> jewelry_slots{ recipe::SLOT_JEWELRY, recipe::SLOT_JEWELRY };
+    auto recipes = make_recipes();
+    resistance req{ 40, 40, 40, 10 };
+
+    // there is only enough memory for one table
+    auto table_bytes = assignment_algorithm::count_values(req) * (sizeof(recipe::cost_t) + 2);
+    caching_assignment algorithm{ std::make_unique<parallel_assignment>(), table_bytes + 1024 };
+
+    parallel_assignment reference;
+    for (int i = 0; i < 3; ++i)
+    {
+        auto result = algorithm.find_minimal_assignment(req, armour_slots, recipes);
+        REQUIRE(result.cost() == reference.find_minimal_assignment(req, armour_slots, recipes).cost());
+
+        result = algorithm.find_minimal_assignment(req, jewelry_slots, recipes);
+        REQUIRE(result.cost() == reference.find_minimal_assignment(req, jewelry_slots, recipes).cost());
+    }
+
+    REQUIRE(algorithm.size() == 1);
+    REQUIRE(algorithm.size_bytes() <= algorithm.max_bytes());
+    REQUIRE(algorithm.cache_stats().hits == 0);
+    REQUIRE(algorithm.cache_stats().misses == 6);
+    REQUIRE(algorithm.cache_stats().evictions == 5);
+}
+
+TEST_CASE("Tables larger than the cache are not cached", "[cache]")
+{
+    using namespace recap;
+
+    std::vector<recipe::slot_t> slots{ recipe::SLOT_ARMOUR, recipe::SLOT_JEWELRY };
+    auto recipes = make_recipes();
+    resistance req{ 40, 40, 10, 10 };
+
+    caching_assignment algorithm{ std::make_unique<parallel_assignment>(), 1024 };
+    parallel_assignment reference;
+
+    auto result = algorithm.find_minimal_assignment(req, slots, recipes);
+    REQUIRE(result.cost() == reference.find_minimal_assignment(req, slots, recipes).cost());
+    REQUIRE(algorithm.size() == 0);
+    REQUIRE(algorithm.size_bytes() == 0);
+    REQUIRE(algorithm.cache_stats().misses == 1);
+}
+
+TEST_CASE("Split algorithm only recomputes the group of slots which changed", "[cache]")
+{
+    using namespace recap;
+
+    auto recipes = make_recipes();
+    resistance req{ 40, 40, 20, 10 };
+
+    auto armour = std::make_unique<caching_assignment>(std::make_unique<parallel_assignment>(), 1 << 24);
+    auto jewelry = std::make_unique<caching_assignment>(std::make_unique<parallel_assignment>(), 1 << 24);
+    auto& armour_cache = *armour;
+    auto& jewelry_cache = *jewelry;
+    split_assignment algorithm{ std::move(armour), std::move(jewelry) };
+    parallel_assignment reference;
+
+    std::vector<recipe::slot_t> slots{ recipe::SLOT_ARMOUR, recipe::SLOT_ARMOUR, recipe::SLOT_JEWELRY };
+    auto result = algorithm.find_minimal_assignment(req, slots, recipes);
+    verify_slots(slots, result);
+    REQUIRE(result.cost() == reference.find_minimal_assignment(req, slots, recipes).cost());
+    REQUIRE(armour_cache.cache_stats().misses == 1);
+    REQUIRE(jewelry_cache.cache_stats().misses == 1);
+
+    // add a jewelry slot
+    slots.push_back(recipe::SLOT_JEWELRY);
+    result = algorithm.find_minimal_assignment(req, slots, recipes);
+    verify_slots(slots, result);
+    REQUIRE(result.cost() == reference.find_minimal_assignment(req, slots, recipes).cost());
+    REQUIRE(armour_cache.cache_stats().hits == 1);
+    REQUIRE(armour_cache.cache_stats().misses == 1);
+    REQUIRE(jewelry_cache.cache_stats().misses == 2);
+}
\ No newline at end of file
@@ -0,0 +1,240 @@
+#include <vector>
+#include <array>
+
+#include "catch_amalgamated.hpp"
+#include "layer_engine.hpp"
+#include "parallel_assignment.hpp"
+#include "test_helpers.hpp"
+
+namespace
+{
+    // Slots of a table with layers of both groups of make_recipes()
+    const std::vector<recap::recipe::slot_t> engine_slots{
+        recap::recipe::SLOT_BODY,
+        recap::recipe::SLOT_RING1,
+        recap::recipe::SLOT_HELMET,
+        recap::recipe::SLOT_AMULET,
+        recap::recipe::SLOT_GLOVES,
+    };
+}
+
+TEST_CASE("Layer bounds cover the dependency cone of the required cell", "[layer_engine]")
+{
+    using namespace recap;
+
+    auto recipes = make_recipes();
+    resistance req{ 60, 45, 50, 20 };
+    solution_table table;
+    table.resize(req, engine_slots, layout_kind::dense);
+    recipe_store store;
+    store.compile(recipes, engine_slots, req, table.layout());
+
+    auto full = compute_layer_bounds(req, store, engine_slots.size(), nullptr, false);
+    auto cone = compute_layer_bounds(req, store, engine_slots.size(), nullptr, true);
+    REQUIRE(cone.max_delta == full.max_delta);
+    REQUIRE(cone.reach == full.reach);
+
+    for (std::size_t i = 0; i < engine_slots.size(); ++i)
+    {
+        REQUIRE(full.max_delta[i] == store.group_max_resistances(store.layer_group(i)));
+        REQUIRE(full.begin[i] == resistance::make_zero());
+        REQUIRE(full.reach[i] <= req);
+    }
+
+    // the last layer only computes the required cell, other layers the cells it reads
+    REQUIRE(cone.begin.back() == req);
+    REQUIRE(full.reach.front() == resistance::make_zero());
+    for (std::size_t i = 1; i < engine_slots.size(); ++i)
+    {
+        REQUIRE(cone.begin[i - 1] == cone.begin[i] - full.max_delta[i]);
+        REQUIRE(full.reach[i] >= full.reach[i - 1]);
+    }
+
+    // resistances crafted in a slot can be kept in its layer
+    std::vector<resistance> crafted(engine_slots.size(), resistance::make_zero());
+    crafted[2] = resistance{ 0, 0, 0, 40 };
+    auto recrafted = compute_layer_bounds(req, store, engine_slots.size(), &crafted, true);
+    REQUIRE(recrafted.max_delta[2].chaos() == 40);
+    REQUIRE(recrafted.max_delta[3] == full.max_delta[3]);
+}
+
+TEST_CASE("Layer engine maps cells like the table layout", "[layer_engine]")
+{
+    using namespace recap;
+
+    auto recipes = make_recipes();
+    resistance req{ 20, 0, 15, 10 };
+    for (auto kind : { layout_kind::dense, layout_kind::padded, layout_kind::tiled })
+    {
+        solution_table table;
+        table.resize(req, engine_slots, kind);
+        recipe_store store;
+        store.compile(recipes, engine_slots, req, table.layout());
+        auto bounds = compute_layer_bounds(req, store, engine_slots.size(), nullptr, false);
+        layer_monitor monitor{ engine_slots.size(), nullptr };
+        layer_engine<3, recipe::cost_t> engine{
+            req, nullptr, store, table, bounds, 1, simd::get_relax_run(simd::isa::scalar), monitor
+        };
+
+        REQUIRE(engine.extent() == std::array<std::size_t, 3>{ 21, 16, 11 });
+        for (resistance::item_t fire = 0; fire <= req.fire(); ++fire)
+        {
+            for (resistance::item_t lightning = 0; lightning <= req.lightning(); ++lightning)
+            {
+                for (resistance::item_t chaos = 0; chaos <= req.chaos(); ++chaos)
+                {
+                    resistance cell{ fire, 0, lightning, chaos };
+                    REQUIRE(engine.project(cell) == std::array<std::size_t, 3>{ fire, lightning, chaos });
+                    REQUIRE(engine.index_of(engine.project(cell)) == table.layout().index(cell));
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Recipes which can't lower any cost of a block are useless", "[layer_engine]")
+{
+    using namespace recap;
+    using engine_t = layer_engine<2, recipe::cost_t>;
+
+    auto recipes = make_recipes();
+    resistance req{ 0, 0, 7, 7 };
+    solution_table table;
+    table.resize(req, engine_slots, layout_kind::dense);
+    recipe_store store;
+    store.compile(recipes, engine_slots, req, table.layout());
+    auto bounds = compute_layer_bounds(req, store, engine_slots.size(), nullptr, false);
+    layer_monitor monitor{ engine_slots.size(), nullptr };
+    engine_t engine{ req, nullptr, store, table, bounds, 1, simd::get_relax_run(simd::isa::scalar), monitor };
+
+    // costs of the previous layer grow with the first dimension, the next layer costs 10 everywhere
+    std::vector<recipe::cost_t> prev_cost(table.value_count());
+    std::vector<recipe::cost_t> next_cost(table.value_count(), 10);
+    for (std::size_t first = 0; first < 8; ++first)
+    {
+        for (std::size_t second = 0; second < 8; ++second)
+        {
+            prev_cost[engine.index_of({ first, second })] = static_cast<recipe::cost_t>(first);
+        }
+    }
+
+    // cells of the last layer can use any cell of the previous layer
+    auto layer = engine_slots.size() - 1;
+    engine_t::block item{ layer, { 0, 0 }, { 8, 8 }, prev_cost.data(), next_cost.data(), 0, table.choices(layer) };
+    REQUIRE(engine.is_useless(item, { 0, 0 }, 10, { 0, 0 }, { 7, 7 }));
+    REQUIRE_FALSE(engine.is_useless(item, { 0, 0 }, 9, { 0, 0 }, { 7, 7 }));
+    REQUIRE(engine.is_useless(item, { 0, 0 }, 9, { 1, 0 }, { 7, 7 }));
+    REQUIRE(engine.is_useless(item, { 2, 0 }, 8, { 4, 0 }, { 7, 7 }));
+
+    // a useless recipe doesn't evaluate any cell
+    engine.relax(item, { 0, 0 }, 0, 10, 1);
+    REQUIRE(item.evaluations == 0);
+    REQUIRE(item.improvements == 0);
+    REQUIRE(next_cost == std::vector<recipe::cost_t>(table.value_count(), 10));
+
+    // only rows with a cheaper cost in the previous layer are improved
+    engine.relax(item, { 0, 0 }, 0, 8, 1);
+    REQUIRE(item.improvements == 2 * 8);
+    for (std::size_t first = 0; first < 8; ++first)
+    {
+        for (std::size_t second = 0; second < 8; ++second)
+        {
+            auto index = engine.index_of({ first, second });
+            REQUIRE(next_cost[index] == std::min<recipe::cost_t>(10, 8 + first));
+            if (first < 2)
+            {
+                REQUIRE(table.choices(layer)[index] == 1);
+            }
+        }
+    }
+}
+
+TEST_CASE("Double buffering and in-place slabs compute the same layers", "[layer_engine]")
+{
+    using namespace recap;
+    using engine_t = layer_engine<4, recipe::cost_t>;
+
+    auto recipes = make_recipes();
+    resistance req{ 30, 25, 20, 12 };
+    solution_table table;
+    table.resize(req, engine_slots, layout_kind::dense);
+    recipe_store store;
+    store.compile(recipes, engine_slots, req, table.layout());
+    auto bounds = compute_layer_bounds(req, store, engine_slots.size(), nullptr, false);
+    auto relax_run = simd::get_relax_run(simd::isa::scalar);
+
+    layer_monitor double_monitor{ engine_slots.size(), nullptr };
+    engine_t double_engine{ req, nullptr, store, table, bounds, 1, relax_run, double_monitor };
+    std::vector<recipe::cost_t> first(table.value_count());
+    std::vector<recipe::cost_t> second(table.value_count());
+    double_engine.initialize(first.data());
+    auto* double_cost = double_engine.run_double_buffer({ first.data(), second.data() }, 4);
+
+    // the last layer is in the second buffer after an odd number of layers
+    REQUIRE(double_cost == second.data());
+
+    layer_monitor in_place_monitor{ engine_slots.size(), nullptr };
+    engine_t in_place_engine{ req, nullptr, store, table, bounds, 1, relax_run, in_place_monitor };
+    std::vector<recipe::cost_t> in_place_cost(table.value_count());
+    in_place_engine.initialize(in_place_cost.data());
+    REQUIRE(in_place_engine.run_in_place(in_place_cost.data()) > 0);
+
+    // the engine computes the same costs as the algorithm
+    parallel_assignment reference{ simd::isa::scalar };
+    const auto& expected = reference.build_table(req, engine_slots, recipes);
+    REQUIRE(expected.value_count() == table.value_count());
+    for (std::size_t i = 0; i < table.value_count(); ++i)
+    {
+        REQUIRE(double_cost[i] == expected.costs()[i]);
+        REQUIRE(in_place_cost[i] == expected.costs()[i]);
+    }
+
+    // both monitors report every cell of every layer
+    solve_statistics double_stats;
+    solve_statistics in_place_stats;
+    double_monitor.report(double_stats, 0);
+    in_place_monitor.report(in_place_stats, 0);
+    REQUIRE(double_stats.layers.size() == engine_slots.size());
+    REQUIRE(in_place_stats.layers.size() == engine_slots.size());
+    for (std::size_t i = 0; i < engine_slots.size(); ++i)
+    {
+        REQUIRE(double_stats.layers[i].layer == i);
+        REQUIRE(double_stats.layers[i].cells == 31 * 26 * 21 * 13);
+        REQUIRE(in_place_stats.layers[i].cells == 31 * 26 * 21 * 13);
+    }
+}
+
+TEST_CASE("Quantized costs of the last layer are widened in the cost table", "[layer_engine]")
+{
+    using namespace recap;
+    using engine_t = layer_engine<2, simd::quantized_cost_t>;
+
+    // odd number of cells
+    auto recipes = make_recipes();
+    resistance req{ 0, 0, 12, 14 };
+    solution_table table;
+    table.resize(req, engine_slots, layout_kind::dense);
+    recipe_store store;
+    store.compile(recipes, engine_slots, req, table.layout());
+    auto bounds = compute_layer_bounds(req, store, engine_slots.size(), nullptr, false);
+    layer_monitor monitor{ engine_slots.size(), nullptr };
+    engine_t engine{ req, nullptr, store, table, bounds, 4, simd::get_relax_run_quantized(simd::isa::scalar), monitor };
+
+    // both quantized layers are in the cost table (the last layer is in the first one)
+    auto value_count = table.value_count();
+    REQUIRE(value_count % 2 == 1);
+    auto quantized = engine.quantized_costs();
+    REQUIRE(static_cast<void*>(quantized) == static_cast<void*>(table.costs()));
+    for (std::size_t k = 0; k < value_count; ++k)
+    {
+        quantized[k] = k % 4 == 3 ? engine_t::max_value() : static_cast<simd::quantized_cost_t>(k * 3);
+        quantized[value_count + k] = 7;
+    }
+    engine.convert();
+
+    for (std::size_t k = 0; k < value_count; ++k)
+    {
+        auto expected = k % 4 == 3 ? recipe::MAX_COST : static_cast<recipe::cost_t>(k * 3) / 4;
+        REQUIRE(table.costs()[k] == expected);
+    }
+}
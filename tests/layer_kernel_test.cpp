@@ -0,0 +1,154 @@
+#include <random>
+#include <algorithm>
+
+#include "catch_amalgamated.hpp"
+#include "layer_kernel.hpp"
+#include "parallel_assignment.hpp"
+#include "test_helpers.hpp"
+
+static const std::array<recap::simd::isa, 4> all_isa{
+    recap::simd::isa::scalar,
+    recap::simd::isa::sse42,
+    recap::simd::isa::avx2,
+    recap::simd::isa::avx512,
+};
+
+TEST_CASE("Layer kernels are equivalent to the scalar kernel", "[layer_kernel]")
+{
+    using namespace recap;
+
+    std::mt19937 gen{ 42 };
+    std::uniform_int_distribution<int> cost_dist{ 0, 20 };
+
+    auto reference = simd::get_relax_run(simd::isa::scalar);
+
+    for (auto kernel_isa : all_isa)
+    {
+        if (!simd::is_supported(kernel_isa))
+        {
+            continue;
+        }
+
+        auto kernel = simd::get_relax_run(kernel_isa);
+        for (std::size_t count = 0; count < 50; ++count)
+        {
+            std::vector<simd::cost_t> src(count);
+            std::vector<simd::cost_t> dst(count);
+            std::vector<simd::recipe_index_t> choice(count);
+            for (std::size_t k = 0; k < count; ++k)
+            {
+                // some cells are unreachable
+                auto value = cost_dist(gen);
+                src[k] = value == 0 ? recipe::MAX_COST : static_cast<simd::cost_t>(value);
+                dst[k] = k % 3 == 0 ? recipe::MAX_COST : static_cast<simd::cost_t>(cost_dist(gen));
+                choice[k] = static_cast<simd::recipe_index_t>(k);
+            }
+
+            auto expected_dst = dst;
+            auto expected_choice = choice;
+            auto expected_improved = reference(expected_dst.data(), expected_choice.data(), src.data(), count, 2.5f, 200);
+            auto improved = kernel(dst.data(), choice.data(), src.data(), count, 2.5f, 200);
+
+            REQUIRE(dst == expected_dst);
+            REQUIRE(choice == expected_choice);
+            REQUIRE(improved == expected_improved);
+            REQUIRE(expected_improved == static_cast<std::size_t>(std::count(expected_choice.begin(), expected_choice.end(), 200)));
+        }
+    }
+}
+
+TEST_CASE("Quantized layer kernels are equivalent to the scalar kernel", "[layer_kernel]")
+{
+    using namespace recap;
+
+    std::mt19937 gen{ 42 };
+    std::uniform_int_distribution<int> cost_dist{ 0, 0xFFFF };
+
+    auto reference = simd::get_relax_run_quantized(simd::isa::scalar);
+
+    for (auto kernel_isa : all_isa)
+    {
+        if (!simd::is_supported(kernel_isa))
+        {
+            continue;
+        }
+
+        auto kernel = simd::get_relax_run_quantized(kernel_isa);
+        for (std::size_t count = 0; count < 80; ++count)
+        {
+            std::vector<simd::quantized_cost_t> src(count);
+            std::vector<simd::quantized_cost_t> dst(count);
+            std::vector<simd::recipe_index_t> choice(count);
+            for (std::size_t k = 0; k < count; ++k)
+            {
+                // some cells are unreachable and some sums saturate
+                src[k] = k % 5 == 0 ? simd::MAX_QUANTIZED_COST : static_cast<simd::quantized_cost_t>(cost_dist(gen));
+                dst[k] = k % 3 == 0 ? simd::MAX_QUANTIZED_COST : static_cast<simd::quantized_cost_t>(cost_dist(gen));
+                choice[k] = static_cast<simd::recipe_index_t>(k);
+            }
+
+            auto expected_dst = dst;
+            auto expected_choice = choice;
+            auto expected_improved = reference(expected_dst.data(), expected_choice.data(), src.data(), count, 1000, 200);
+            auto improved = kernel(dst.data(), choice.data(), src.data(), count, 1000, 200);
+
+            REQUIRE(dst == expected_dst);
+            REQUIRE(choice == expected_choice);
+            REQUIRE(improved == expected_improved);
+            REQUIRE(expected_improved == static_cast<std::size_t>(std::count(expected_choice.begin(), expected_choice.end(), 200)));
+        }
+    }
+}
+
+TEST_CASE("Every layer kernel finds the same assignment", "[layer_kernel]")
+{
+    using namespace recap;
+
+    std::vector<recipe::slot_t> slots{
+        recipe::SLOT_BODY,
+        recipe::SLOT_HELMET,
+        recipe::SLOT_RING1,
+        recipe::SLOT_AMULET
+    };
+
+    std::vector<recipe> recipes{
+        recipe{ resistance{ 0, 0, 0, 0 }, 0, recipe::SLOT_ALL },
+        recipe{ resistance{ 30, 0, 0, 0 }, 30, recipe::SLOT_ALL },
+        recipe{ resistance{ 0, 30, 0, 0 }, 30, recipe::SLOT_ALL },
+        recipe{ resistance{ 0, 0, 30, 0 }, 30, recipe::SLOT_ALL },
+        recipe{ resistance{ 20, 20, 0, 0 }, 10, recipe::SLOT_ALL },
+        recipe{ resistance{ 20, 0, 20, 0 }, 10, recipe::SLOT_ALL },
+        recipe{ resistance{ 0, 20, 20, 0 }, 10, recipe::SLOT_ALL },
+        recipe{ resistance{ 10, 10, 10, 0 }, 9, recipe::SLOT_JEWELRY },
+        recipe{ resistance{ 15, 0, 0, 15 }, 30, recipe::SLOT_JEWELRY },
+        recipe{ resistance{ 0, 15, 0, 15 }, 30, recipe::SLOT_JEWELRY },
+        recipe{ resistance{ 0, 0, 15, 35 }, 30, recipe::SLOT_JEWELRY },
+    };
+    resistance req{ 29, 37, 23, 40 };
+
+    parallel_assignment reference{ simd::isa::scalar };
+    auto expected = reference.find_minimal_assignment(req, slots, recipes);
+    REQUIRE(expected.cost() < recipe::MAX_COST);
+    verify_assignment(req, slots, expected);
+
+    for (auto kernel_isa : all_isa)
+    {
+        if (!simd::is_supported(kernel_isa))
+        {
+            continue;
+        }
+
+        parallel_assignment algorithm{ kernel_isa };
+        auto result = algorithm.find_minimal_assignment(req, slots, recipes);
+        verify_assignment(req, slots, result);
+        REQUIRE(result.cost() == expected.cost());
+
+        // kernels have to choose the same recipe in each slot
+        REQUIRE(result.assignments().size() == expected.assignments().size());
+        for (std::size_t i = 0; i < expected.assignments().size(); ++i)
+        {
+            REQUIRE(result.assignments()[i].slot() == expected.assignments()[i].slot());
+            REQUIRE(result.assignments()[i].used_recipe() == expected.assignments()[i].used_recipe());
+        }
+    }
+}
\ No newline at end of file
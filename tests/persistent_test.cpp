@@ -0,0 +1,372 @@
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <thread>
+#include <atomic>
+
+#include "catch_amalgamated.hpp"
+#include "persistent_assignment.hpp"
+#include "parallel_assignment.hpp"
+#include "table_file.hpp"
+#include "test_helpers.hpp"
+
+// Empty directory which is removed at the end of a test
+class temp_directory
+{
+public:
+    temp_directory()
+    {
+        std::random_device device;
+        path_ = std::filesystem::temp_directory_path() / 
+            ("recap_test_" + std::to_string(device()) + "_" + std::to_string(device()));
+        std::filesystem::remove_all(path_);
+    }
+
+    ~temp_directory()
+    {
+        std::error_code error;
+        std::filesystem::remove_all(path_, error);
+    }
+
+    std::string path() const 
+    {
+        return path_.string();
+    }
+
+    std::size_t file_count() const
+    {
+        if (!std::filesystem::exists(path_))
+        {
+            return 0;
+        }
+
+        std::size_t count = 0;
+        for (auto& item : std::filesystem::directory_iterator{ path_ })
+        {
+            (void)item;
+            ++count;
+        }
+        return count;
+    }
+
+private:
+    std::filesystem::path path_;
+};
+
+TEST_CASE("Load stored table in a new instance", "[persistent]")
+{
+    using namespace recap;
+
+    std::vector<recipe::slot_t> slots{
+        recipe::SLOT_ARMOUR,
+        recipe::SLOT_ARMOUR,
+        recipe::SLOT_JEWELRY,
+    };
+    auto recipes = make_recipes();
+    temp_directory dir;
+
+    parallel_assignment reference;
+    std::vector<resistance> requirements{
+        resistance{ 40, 40, 20, 10 },
+        resistance{ 30, 20, 20, 0 },
+        resistance{ 0, 0, 0, 0 },
+        resistance{ 40, 0, 20, 10 },
+    };
+
+    {
+        persistent_assignment algorithm{ std::make_unique<parallel_assignment>(), dir.path(), table_store_mode::read_write };
+        auto result = algorithm.find_minimal_assignment(requirements[0], slots, recipes);
+        REQUIRE(algorithm.cache_stats().misses == 1);
+        REQUIRE(algorithm.cache_stats().hits == 0);
+        REQUIRE(result.cost() == reference.find_minimal_assignment(requirements[0], slots, recipes).cost());
+        REQUIRE(dir.file_count() == 1);
+    }
+
+    // a new instance (e.g., a new process) answers queries from the stored table
+    persistent_assignment algorithm{ std::make_unique<parallel_assignment>(), dir.path(), table_store_mode::read_only };
+    for (auto required : requirements)
+    {
+        auto& table = algorithm.build_table(required, slots, recipes);
+        REQUIRE(table.is_read_only());
+        REQUIRE(table.max_resistances() == requirements[0]);
+
+        auto result = table.find_assignment(required, recipes);
+        auto expected = reference.find_minimal_assignment(required, slots, recipes);
+        REQUIRE(result.cost() == expected.cost());
+        REQUIRE(result.assignments().size() == expected.assignments().size());
+    }
+    REQUIRE(algorithm.cache_stats().misses == 0);
+    REQUIRE(algorithm.cache_stats().hits == requirements.size());
+
+    // slots are interchangeable
+    std::vector<recipe::slot_t> reordered_slots{
+        recipe::SLOT_JEWELRY,
+        recipe::SLOT_ARMOUR,
+        recipe::SLOT_ARMOUR,
+    };
+    auto result = algorithm.find_minimal_assignment(requirements[1], reordered_slots, recipes);
+    REQUIRE(algorithm.cache_stats().hits == requirements.size() + 1);
+    REQUIRE(result.cost() == reference.find_minimal_assignment(requirements[1], reordered_slots, recipes).cost());
+}
+
+TEST_CASE("Tables in other layouts are stored in the dense layout", "[persistent]")
+{
+    using namespace recap;
+
+    std::vector<recipe::slot_t> slots{
+        recipe::SLOT_ARMOUR,
+        recipe::SLOT_ARMOUR,
+        recipe::SLOT_JEWELRY,
+    };
+    auto recipes = make_recipes();
+    temp_directory dir;
+
+    parallel_assignment reference;
+    resistance max_res{ 41, 38, 21, 10 };
+
+    {
+        persistent_assignment algorithm{ 
+            std::make_unique<parallel_assignment>(simd::detect_isa(), layer_update::double_buffer, layout_kind::tiled), 
+            dir.path(), 
+            table_store_mode::read_write 
+        };
+        algorithm.build_table(max_res, slots, recipes);
+        REQUIRE(dir.file_count() == 1);
+    }
+
+    persistent_assignment algorithm{ std::make_unique<parallel_assignment>(), dir.path(), table_store_mode::read_only };
+    auto& table = algorithm.build_table(max_res, slots, recipes);
+    REQUIRE(table.is_read_only());
+    REQUIRE(table.layout().kind() == layout_kind::dense);
+    REQUIRE(algorithm.cache_stats().hits == 1);
+
+    const auto& expected = reference.build_table(max_res, slots, recipes);
+    REQUIRE(table.value_count() == expected.value_count());
+    for (std::size_t i = 0; i < table.value_count(); ++i)
+    {
+        REQUIRE(table.costs()[i] == expected.costs()[i]);
+    }
+    for (std::size_t layer = 0; layer < table.layer_count(); ++layer)
+    {
+        for (std::size_t i = 0; i < table.value_count(); ++i)
+        {
+            REQUIRE(table.choices(layer)[i] == expected.choices(layer)[i]);
+        }
+    }
+}
+
+TEST_CASE("Read-only cache doesn't store tables", "[persistent]")
+{
+    using namespace recap;
+
+    std::vector<recipe::slot_t> slots{ recipe::SLOT_ARMOUR, recipe::SLOT_JEWELRY };
+    auto recipes = make_recipes();
+    temp_directory dir;
+
+    persistent_assignment algorithm{ std::make_unique<parallel_assignment>(), dir.path(), table_store_mode::read_only };
+    algorithm.find_minimal_assignment(resistance{ 20, 20, 10, 0 }, slots, recipes);
+    algorithm.find_minimal_assignment(resistance{ 20, 20, 10, 0 }, slots, recipes);
+    REQUIRE(algorithm.cache_stats().misses == 2);
+    REQUIRE(algorithm.cache_stats().hits == 0);
+    REQUIRE(dir.file_count() == 0);
+}
+
+TEST_CASE("Stored table is not used for a different problem", "[persistent]")
+{
+    using namespace recap;
+
+    std::vector<recipe::slot_t> slots{ recipe::SLOT_ARMOUR, recipe::SLOT_JEWELRY };
+    auto recipes = make_recipes();
+    temp_directory dir;
+
+    persistent_assignment algorithm{ std::make_unique<parallel_assignment>(), dir.path(), table_store_mode::read_write };
+    algorithm.find_minimal_assignment(resistance{ 20, 20, 10, 0 }, slots, recipes);
+    REQUIRE(algorithm.cache_stats().misses == 1);
+
+    // larger requirement
+    algorithm.find_minimal_assignment(resistance{ 30, 20, 10, 0 }, slots, recipes);
+    REQUIRE(algorithm.cache_stats().misses == 2);
+    REQUIRE(dir.file_count() == 2);
+
+    // different slots
+    algorithm.find_minimal_assignment(resistance{ 20, 20, 10, 0 }, std::vector<recipe::slot_t>{ recipe::SLOT_ARMOUR }, recipes);
+    REQUIRE(algorithm.cache_stats().misses == 3);
+
+    // different recipes
+    auto other_recipes = recipes;
+    other_recipes.back() = recipe{ resistance{ 15, 0, 0, 15 }, 29, recipe::SLOT_JEWELRY };
+    parallel_assignment reference;
+    auto result = algorithm.find_minimal_assignment(resistance{ 20, 20, 10, 0 }, slots, other_recipes);
+    REQUIRE(algorithm.cache_stats().misses == 4);
+    REQUIRE(result.cost() == reference.find_minimal_assignment(resistance{ 20, 20, 10, 0 }, slots, other_recipes).cost());
+
+    // the smallest table which contains the requirement is used
+    persistent_assignment other{ std::make_unique<parallel_assignment>(), dir.path(), table_store_mode::read_only };
+    auto& table = other.build_table(resistance{ 10, 10, 10, 0 }, slots, recipes);
+    REQUIRE(other.cache_stats().hits == 1);
+    REQUIRE(table.max_resistances() == resistance{ 20, 20, 10, 0 });
+}
+
+TEST_CASE("Tables with rounded costs are only used by quantized algorithms", "[persistent]")
+{
+    using namespace recap;
+
+    std::vector<recipe::slot_t> slots{ recipe::SLOT_BODY, recipe::SLOT_HELMET, recipe::SLOT_GLOVES };
+    std::vector<recipe> recipes{
+        recipe{ resistance{ 0, 0, 0, 0 }, 0, recipe::SLOT_ALL },
+        recipe{ resistance{ 10, 1, 0, 0 }, 11.9f, recipe::SLOT_ALL },
+        recipe{ resistance{ 10, 0, 0, 0 }, 5, recipe::SLOT_ALL },
+        recipe{ resistance{ 0, 1, 0, 0 }, 5, recipe::SLOT_ALL },
+        recipe{ resistance{ 0, 0, 1, 0 }, 100000, recipe::SLOT_ALL },
+    };
+    resistance req{ 10, 1, 1, 0 };
+    temp_directory dir;
+
+    auto make_quantized = []()
+    {
+        return std::make_unique<parallel_assignment>(
+            simd::detect_isa(), layer_update::double_buffer, layout_kind::dense, cost_precision::quantized);
+    };
+
+    // rounding makes the quantized algorithm choose a more expensive assignment
+    parallel_assignment reference;
+    auto expected = reference.find_minimal_assignment(req, slots, recipes);
+    REQUIRE(expected.cost() == 100010);
+    {
+        persistent_assignment algorithm{ make_quantized(), dir.path(), table_store_mode::read_write };
+        auto result = algorithm.find_minimal_assignment(req, slots, recipes);
+        REQUIRE(result.cost() > expected.cost());
+        REQUIRE(dir.file_count() == 1);
+    }
+
+    // an exact algorithm computes and stores its own table
+    {
+        persistent_assignment algorithm{ std::make_unique<parallel_assignment>(), dir.path(), table_store_mode::read_write };
+        auto result = algorithm.find_minimal_assignment(req, slots, recipes);
+        REQUIRE(algorithm.solve_stats().tables_reused == 0);
+        REQUIRE(algorithm.cache_stats().misses == 1);
+        REQUIRE(result.cost() == expected.cost());
+        verify_assignment(req, slots, result);
+        REQUIRE(dir.file_count() == 2);
+    }
+
+    // each precision reuses its own table
+    persistent_assignment exact{ std::make_unique<parallel_assignment>(), dir.path(), table_store_mode::read_only };
+    REQUIRE(exact.find_minimal_assignment(req, slots, recipes).cost() == expected.cost());
+    REQUIRE(exact.cache_stats().hits == 1);
+
+    persistent_assignment quantized{ make_quantized(), dir.path(), table_store_mode::read_only };
+    REQUIRE(quantized.find_minimal_assignment(req, slots, recipes).cost() > expected.cost());
+    REQUIRE(quantized.cache_stats().hits == 1);
+
+    // the precision in the header is checked even if the file has been renamed
+    auto sorted_slots = slots;
+    std::sort(sorted_slots.begin(), sorted_slots.end());
+    auto quantized_path = std::filesystem::path{ dir.path() } / 
+        table_file_name(hash_recipes(recipes), hash_slots(sorted_slots), req, cost_precision::quantized);
+    solution_table table;
+    REQUIRE(map_table_file(quantized_path.string(), recipes, cost_precision::quantized, table));
+    REQUIRE(!map_table_file(quantized_path.string(), recipes, cost_precision::exact, table));
+}
+
+TEST_CASE("Corrupted table file is ignored", "[persistent]")
+{
+    using namespace recap;
+
+    std::vector<recipe::slot_t> slots{ recipe::SLOT_ARMOUR, recipe::SLOT_JEWELRY };
+    auto recipes = make_recipes();
+    temp_directory dir;
+
+    {
+        persistent_assignment algorithm{ std::make_unique<parallel_assignment>(), dir.path(), table_store_mode::read_write };
+        algorithm.find_minimal_assignment(resistance{ 20, 20, 10, 0 }, slots, recipes);
+    }
+
+    // truncate the stored file
+    for (auto& item : std::filesystem::directory_iterator{ dir.path() })
+    {
+        std::filesystem::resize_file(item.path(), std::filesystem::file_size(item.path()) - 1);
+    }
+
+    persistent_assignment algorithm{ std::make_unique<parallel_assignment>(), dir.path(), table_store_mode::read_only };
+    parallel_assignment reference;
+    auto result = algorithm.find_minimal_assignment(resistance{ 20, 20, 10, 0 }, slots, recipes);
+    REQUIRE(algorithm.cache_stats().hits == 0);
+    REQUIRE(algorithm.cache_stats().misses == 1);
+    REQUIRE(result.cost() == reference.find_minimal_assignment(resistance{ 20, 20, 10, 0 }, slots, recipes).cost());
+}
+
+TEST_CASE("Concurrent writers store a complete table", "[persistent]")
+{
+    using namespace recap;
+
+    std::vector<recipe::slot_t> slots{ recipe::SLOT_ARMOUR, recipe::SLOT_ARMOUR, recipe::SLOT_JEWELRY };
+    auto recipes = make_recipes();
+    resistance max_res{ 40, 40, 20, 10 };
+    temp_directory dir;
+    std::filesystem::create_directories(dir.path());
+
+    parallel_assignment algorithm;
+    const auto& table = algorithm.build_table(max_res, slots, recipes);
+    auto path = (std::filesystem::path{ dir.path() } / table_file_name(hash_recipes(recipes), hash_slots(slots), max_res, cost_precision::exact)).string();
+
+    // both writers store the same table to the same path over and over
+    std::atomic<std::size_t> failures{ 0 };
+    auto write = [&]()
+    {
+        for (std::size_t i = 0; i < 20; ++i)
+        {
+            try
+            {
+                write_table_file(path, table, recipes, cost_precision::exact);
+            }
+            catch (std::runtime_error&)
+            {
+                ++failures;
+            }
+        }
+    };
+    std::thread first{ write };
+    std::thread second{ write };
+    first.join();
+    second.join();
+    REQUIRE(failures == 0);
+
+    // temporary files are removed
+    REQUIRE(dir.file_count() == 1);
+
+    solution_table stored;
+    REQUIRE(map_table_file(path, recipes, cost_precision::exact, stored));
+    auto value_count = assignment_algorithm::count_values(max_res);
+    const auto& view = stored;
+    REQUIRE(std::equal(view.costs(), view.costs() + value_count, table.costs()));
+    for (std::size_t i = 0; i < slots.size(); ++i)
+    {
+        REQUIRE(std::equal(view.choices(i), view.choices(i) + value_count, table.choices(i)));
+    }
+}
+
+TEST_CASE("Parse table file names", "[persistent]")
+{
+    using namespace recap;
+
+    auto name = table_file_name(0x0123456789abcdefull, 42, resistance{ 75, 76, 77, 0 }, cost_precision::exact);
+
+    std::uint64_t recipes_hash, slots_hash;
+    resistance max_res;
+    cost_precision precision;
+    REQUIRE(parse_table_file_name(name, recipes_hash, slots_hash, max_res, precision));
+    REQUIRE(recipes_hash == 0x0123456789abcdefull);
+    REQUIRE(slots_hash == 42);
+    REQUIRE(max_res == resistance{ 75, 76, 77, 0 });
+    REQUIRE(precision == cost_precision::exact);
+
+    // tables with rounded costs have a different name
+    auto quantized_name = table_file_name(0x0123456789abcdefull, 42, resistance{ 75, 76, 77, 0 }, cost_precision::quantized);
+    REQUIRE(quantized_name != name);
+    REQUIRE(parse_table_file_name(quantized_name, recipes_hash, slots_hash, max_res, precision));
+    REQUIRE(precision == cost_precision::quantized);
+
+    REQUIRE(!parse_table_file_name(name + ".tmp", recipes_hash, slots_hash, max_res, precision));
+    REQUIRE(!parse_table_file_name("recipes.csv", recipes_hash, slots_hash, max_res, precision));
+}
\ No newline at end of file
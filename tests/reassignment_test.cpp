@@ -98,4 +98,66 @@ TEST_CASE("No solution", "[reassignment]")
     auto result = algorithm.find_minimal_reassignment(current, req, items, recipes);
     REQUIRE(result.cost() == recipe::MAX_COST);
     REQUIRE(result.assignments().size() == 0);
-}
\ No newline at end of file
+}
+
+TEST_CASE("Recrafting in one pass is the same as trying all subsets", "[reassignment]")
+{
+    using namespace recap;
+
+    std::vector<recipe::slot_t> slots{
+        recipe::SLOT_HELMET,
+        recipe::SLOT_BODY,
+        recipe::SLOT_GLOVES,
+        recipe::SLOT_RING1,
+    };
+
+    std::vector<resistance> crafted{
+        resistance{ 10, 0, 0, 0 },
+        resistance{ 0, 12, 0, 3 },
+        resistance{ 6, 0, 6, 0 },
+        resistance{ 0, 0, 0, 9 },
+    };
+
+    std::vector<recipe> recipes{
+        recipe{ resistance{ 0, 0, 0, 0 }, 0, recipe::SLOT_ALL },
+        recipe{ resistance{ 5, 5, 0, 0 }, 1, recipe::SLOT_ALL },
+        recipe{ resistance{ 5, 0, 5, 0 }, 1, recipe::SLOT_ALL },
+        recipe{ resistance{ 0, 5, 5, 0 }, 1, recipe::SLOT_ALL },
+        recipe{ resistance{ 10, 0, 0, 0 }, 10, recipe::SLOT_ARMOUR },
+        recipe{ resistance{ 0, 10, 0, 0 }, 10, recipe::SLOT_ARMOUR },
+        recipe{ resistance{ 0, 0, 10, 0 }, 10, recipe::SLOT_ARMOUR },
+        recipe{ resistance{ 0, 0, 0, 8 }, 4, recipe::SLOT_JEWELRY },
+    };
+
+    parallel_assignment algorithm;
+    parallel_assignment in_place{ simd::detect_isa(), layer_update::in_place };
+    for (resistance::item_t fire = 0; fire <= 20; fire += 5)
+    {
+        for (resistance::item_t cold = 0; cold <= 20; cold += 4)
+        {
+            for (resistance::item_t chaos = 0; chaos <= 12; chaos += 6)
+            {
+                resistance req{ fire, cold, 8, chaos };
+
+                auto result = algorithm.find_minimal_recrafting(req, slots, crafted, recipes);
+                auto expected = algorithm.assignment_algorithm::find_minimal_recrafting(req, slots, crafted, recipes);
+                REQUIRE(result.cost() == expected.cost());
+                REQUIRE(in_place.find_minimal_recrafting(req, slots, crafted, recipes).cost() == expected.cost());
+
+                // the default implementation solves each subset of recrafted slots separately
+                REQUIRE(algorithm.solve_stats().reassignment_subsets == 1 + (std::size_t{ 1 } << slots.size()));
+                algorithm.clear_solve_stats();
+
+                if (result.cost() < recipe::MAX_COST)
+                {
+                    recipe::cost_t total_cost = 0;
+                    for (auto assign : result.assignments())
+                    {
+                        total_cost += assign.used_recipe().cost();
+                    }
+                    REQUIRE(result.cost() == total_cost);
+                }
+            }
+        }
+    }
+}
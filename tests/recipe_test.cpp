@@ -1,5 +1,6 @@
 #include "catch_amalgamated.hpp"
 #include "recipe.hpp"
+#include "recipe_store.hpp"
 
 TEST_CASE("Serialize and deserialize slot", "[recipe]")
 {
@@ -29,4 +30,140 @@ TEST_CASE("Serialize and deserialize slot", "[recipe]")
         REQUIRE(slot_parsed == slot);
     }
     REQUIRE(to_string(recipe::slot_t{ 17 }) == "<unknown>");
-}
\ No newline at end of file
+}
+
+TEST_CASE("Remove recipes dominated by a cheaper recipe", "[recipe]")
+{
+    using namespace recap;
+
+    std::vector<recipe> recipes{
+        recipe{ resistance{ 0, 0, 0, 0 }, 0, recipe::SLOT_ALL },
+        recipe{ resistance{ 10, 0, 0, 0 }, 1, recipe::SLOT_ALL },
+        // same resistances as the previous recipe but more expensive and in fewer slots
+        recipe{ resistance{ 10, 0, 0, 0 }, 2, recipe::SLOT_ARMOUR },
+        // lower resistances for the same cost
+        recipe{ resistance{ 8, 0, 0, 0 }, 1, recipe::SLOT_JEWELRY },
+        // higher resistances so it stays
+        recipe{ resistance{ 12, 0, 0, 0 }, 5, recipe::SLOT_ARMOUR },
+        // cheaper so it stays
+        recipe{ resistance{ 5, 0, 0, 0 }, 0.5f, recipe::SLOT_ARMOUR },
+    };
+
+    auto removed = remove_dominated_recipes(recipes);
+    REQUIRE(removed == 2);
+    REQUIRE(recipes.size() == 4);
+    REQUIRE(recipes[0].resistances() == resistance{ 0, 0, 0, 0 });
+    REQUIRE(recipes[1].cost() == 1);
+    REQUIRE(recipes[2].resistances() == resistance{ 12, 0, 0, 0 });
+    REQUIRE(recipes[3].cost() == 0.5f);
+}
+
+TEST_CASE("Only remove recipes dominated in all of their slots", "[recipe]")
+{
+    using namespace recap;
+
+    std::vector<recipe> recipes{
+        recipe{ resistance{ 10, 10, 0, 0 }, 1, recipe::SLOT_ARMOUR },
+        recipe{ resistance{ 10, 0, 0, 0 }, 1, recipe::SLOT_ALL },
+        recipe{ resistance{ 10, 0, 0, 10 }, 1, recipe::SLOT_JEWELRY },
+        recipe{ resistance{ 0, 10, 0, 0 }, 1, recipe::SLOT_ALL },
+    };
+
+    // recipe 1 is dominated in armour slots by recipe 0 and in jewelry slots by recipe 2
+    // recipe 3 is only dominated in armour slots
+    auto removed = remove_dominated_recipes(recipes);
+    REQUIRE(removed == 1);
+    REQUIRE(recipes.size() == 3);
+    REQUIRE(recipes[1].resistances() == resistance{ 10, 0, 0, 10 });
+    REQUIRE(recipes[2].resistances() == resistance{ 0, 10, 0, 0 });
+}
+
+TEST_CASE("Keep one of equal recipes", "[recipe]")
+{
+    using namespace recap;
+
+    std::vector<recipe> recipes{
+        recipe{ resistance{ 0, 0, 0, 0 }, 0, recipe::SLOT_ALL },
+        recipe{ resistance{ 0, 0, 0, 0 }, 0, recipe::SLOT_ALL },
+        recipe{ resistance{ 5, 5, 0, 0 }, 3, recipe::SLOT_ARMOUR },
+        recipe{ resistance{ 5, 5, 0, 0 }, 3, recipe::SLOT_ARMOUR },
+    };
+
+    auto removed = remove_dominated_recipes(recipes);
+    REQUIRE(removed == 2);
+    REQUIRE(recipes.size() == 2);
+    REQUIRE(recipes[0].resistances() == resistance{ 0, 0, 0, 0 });
+    REQUIRE(recipes[1].resistances() == resistance{ 5, 5, 0, 0 });
+}
+
+TEST_CASE("Find recipes needed in a layer", "[recipe]")
+{
+    using namespace recap;
+
+    std::vector<recipe> recipes{
+        recipe{ resistance{ 0, 0, 0, 0 }, 0, recipe::SLOT_ALL },
+        recipe{ resistance{ 10, 10, 0, 0 }, 1, recipe::SLOT_ARMOUR },
+        recipe{ resistance{ 10, 0, 0, 0 }, 1, recipe::SLOT_ALL },
+        recipe{ resistance{ 10, 0, 0, 10 }, 1, recipe::SLOT_JEWELRY },
+        recipe{ resistance{ 30, 0, 0, 0 }, 3, recipe::SLOT_ALL },
+        recipe{ resistance{ 40, 0, 0, 0 }, 4, recipe::SLOT_ALL },
+    };
+
+    // recipe 2 is dominated by recipe 1 in armour slots and by recipe 3 in jewelry slots
+    REQUIRE(find_layer_recipes(recipes, recipe::SLOT_ARMOUR, resistance{ 50, 50, 50, 50 }) == 
+        std::vector<std::size_t>{ 0, 1, 4, 5 });
+    REQUIRE(find_layer_recipes(recipes, recipe::SLOT_RING1, resistance{ 50, 50, 50, 50 }) == 
+        std::vector<std::size_t>{ 0, 3, 4, 5 });
+
+    // resistances above the requirement are wasted
+    REQUIRE(find_layer_recipes(recipes, recipe::SLOT_ARMOUR, resistance{ 30, 10, 0, 0 }) == 
+        std::vector<std::size_t>{ 0, 1, 4 });
+    REQUIRE(find_layer_recipes(recipes, recipe::SLOT_RING1, resistance{ 30, 10, 0, 0 }) == 
+        std::vector<std::size_t>{ 0, 2, 4 });
+}
+
+TEST_CASE("Compile recipes for each slot mask", "[recipe]")
+{
+    using namespace recap;
+
+    std::vector<recipe> recipes{
+        recipe{ resistance{ 0, 0, 0, 0 }, 0, recipe::SLOT_ALL },
+        recipe{ resistance{ 10, 10, 0, 0 }, 1, recipe::SLOT_ARMOUR },
+        recipe{ resistance{ 10, 0, 0, 0 }, 1, recipe::SLOT_ALL },
+        recipe{ resistance{ 10, 0, 0, 10 }, 1, recipe::SLOT_JEWELRY },
+        recipe{ resistance{ 30, 0, 0, 0 }, 3, recipe::SLOT_ALL },
+    };
+
+    std::vector<recipe::slot_t> slots{
+        recipe::SLOT_BODY,
+        recipe::SLOT_RING1,
+        recipe::SLOT_BODY,
+    };
+
+    resistance max_res{ 20, 20, 5, 5 };
+
+    recipe_store store;
+    store.compile(recipes, slots, max_res);
+    REQUIRE(store.group_count() == 2);
+    REQUIRE(store.layer_group(0) == store.layer_group(2));
+    REQUIRE(store.layer_group(0) != store.layer_group(1));
+
+    // recipe 2 is dominated in both groups, recipe 4 is clamped to the table
+    auto body = store.layer(0);
+    REQUIRE(body.count == 3);
+    REQUIRE(std::vector<std::uint8_t>(body.indices, body.indices + body.count) == std::vector<std::uint8_t>{ 0, 1, 4 });
+    REQUIRE(body.resistances(2) == resistance{ 20, 0, 0, 0 });
+    REQUIRE(body.costs[2] == 3);
+    REQUIRE(store.group_max_resistances(store.layer_group(0)) == resistance{ 20, 10, 0, 0 });
+
+    auto ring = store.layer(1);
+    REQUIRE(ring.count == 3);
+    REQUIRE(std::vector<std::uint8_t>(ring.indices, ring.indices + ring.count) == std::vector<std::uint8_t>{ 0, 3, 4 });
+    REQUIRE(ring.resistances(1) == resistance{ 10, 0, 0, 5 });
+
+    // offset is the linear index of the resistances in the table
+    REQUIRE(ring.offsets[1] == 10 * 21 * 6 * 6 + 5);
+
+    // arrays are aligned
+    REQUIRE(reinterpret_cast<std::uintptr_t>(store.costs().data()) % recipe_store::ALIGNMENT == 0);
+}
@@ -0,0 +1,199 @@
+#include <array>
+#include <random>
+#include <vector>
+
+#include "catch_amalgamated.hpp"
+#include "resistance.hpp"
+
+// Resistances with a separate field for each value (reference implementation)
+struct scalar_resistance
+{
+    using item_t = recap::resistance::item_t;
+
+    item_t fire;
+    item_t cold;
+    item_t lightning;
+    item_t chaos;
+
+    static scalar_resistance from(recap::resistance res)
+    {
+        return scalar_resistance{ res.fire(), res.cold(), res.lightning(), res.chaos() };
+    }
+
+    recap::resistance to_resistance() const
+    {
+        return recap::resistance{ fire, cold, lightning, chaos };
+    }
+
+    scalar_resistance operator+(const scalar_resistance& other) const
+    {
+        return scalar_resistance{
+            static_cast<item_t>(fire + other.fire),
+            static_cast<item_t>(cold + other.cold),
+            static_cast<item_t>(lightning + other.lightning),
+            static_cast<item_t>(chaos + other.chaos)
+        };
+    }
+
+    scalar_resistance operator-(const scalar_resistance& other) const
+    {
+        return scalar_resistance{
+            static_cast<item_t>(fire >= other.fire ? fire - other.fire : 0),
+            static_cast<item_t>(cold >= other.cold ? cold - other.cold : 0),
+            static_cast<item_t>(lightning >= other.lightning ? lightning - other.lightning : 0),
+            static_cast<item_t>(chaos >= other.chaos ? chaos - other.chaos : 0)
+        };
+    }
+
+    bool operator>=(const scalar_resistance& other) const
+    {
+        return fire >= other.fire && 
+            cold >= other.cold && 
+            lightning >= other.lightning && 
+            chaos >= other.chaos;
+    }
+
+    bool operator>(const scalar_resistance& other) const
+    {
+        return fire > other.fire && 
+            cold > other.cold && 
+            lightning > other.lightning && 
+            chaos > other.chaos;
+    }
+
+    bool operator==(const scalar_resistance& other) const
+    {
+        return fire == other.fire && 
+            cold == other.cold && 
+            lightning == other.lightning && 
+            chaos == other.chaos;
+    }
+};
+
+static std::vector<recap::resistance> make_values(std::size_t count)
+{
+    using namespace recap;
+
+    // values close to the boundaries of a lane are the most likely to break carries
+    std::vector<resistance::item_t> interesting{ 0, 1, 2, 0x7FFE, 0x7FFF, 0x8000, 0x8001, 0xFFFE, 0xFFFF };
+
+    std::mt19937 rng{ 7 };
+    std::uniform_int_distribution<std::size_t> pick{ 0, interesting.size() * 2 - 1 };
+    std::uniform_int_distribution<std::uint32_t> small{ 0, 127 };
+    auto value = [&]()
+    {
+        auto index = pick(rng);
+        return index < interesting.size() ? interesting[index] : static_cast<resistance::item_t>(small(rng));
+    };
+
+    std::vector<resistance> result;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        result.push_back(resistance{ value(), value(), value(), value() });
+    }
+    return result;
+}
+
+TEST_CASE("Packed resistance operations are the same as operations on each value", "[resistance]")
+{
+    using namespace recap;
+
+    auto values = make_values(512);
+    for (auto lhs : values)
+    {
+        auto scalar_lhs = scalar_resistance::from(lhs);
+        for (auto rhs : values)
+        {
+            auto scalar_rhs = scalar_resistance::from(rhs);
+
+            REQUIRE((lhs + rhs) == (scalar_lhs + scalar_rhs).to_resistance());
+            REQUIRE((lhs - rhs) == (scalar_lhs - scalar_rhs).to_resistance());
+            REQUIRE((lhs >= rhs) == (scalar_lhs >= scalar_rhs));
+            REQUIRE((lhs <= rhs) == (scalar_rhs >= scalar_lhs));
+            REQUIRE((lhs > rhs) == (scalar_lhs > scalar_rhs));
+            REQUIRE((lhs < rhs) == (scalar_rhs > scalar_lhs));
+            REQUIRE((lhs == rhs) == (scalar_lhs == scalar_rhs));
+        }
+    }
+}
+
+TEST_CASE("Packed resistance benchmark", "[resistance][.][benchmark]")
+{
+    using namespace recap;
+
+    auto values = make_values(4096);
+    std::vector<scalar_resistance> scalar_values;
+    for (auto value : values)
+    {
+        scalar_values.push_back(scalar_resistance::from(value));
+    }
+    auto delta = resistance{ 17, 0, 23, 5 };
+    auto scalar_delta = scalar_resistance::from(delta);
+
+    std::vector<resistance> differences(values.size());
+    BENCHMARK("Saturating subtract (packed)")
+    {
+        for (std::size_t i = 0; i < values.size(); ++i)
+        {
+            differences[i] = values[i] - delta;
+        }
+        return differences.back().packed();
+    };
+
+    std::vector<scalar_resistance> scalar_differences(values.size());
+    BENCHMARK("Saturating subtract (scalar)")
+    {
+        for (std::size_t i = 0; i < scalar_values.size(); ++i)
+        {
+            scalar_differences[i] = scalar_values[i] - scalar_delta;
+        }
+        return scalar_differences.back().fire;
+    };
+
+    // the same check as in remove_dominated_recipes()
+    BENCHMARK("Dominance check (packed)")
+    {
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < 256; ++i)
+        {
+            for (auto value : values)
+            {
+                count += value >= values[i];
+            }
+        }
+        return count;
+    };
+
+    BENCHMARK("Dominance check (scalar)")
+    {
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < 256; ++i)
+        {
+            for (auto& value : scalar_values)
+            {
+                count += value >= scalar_values[i];
+            }
+        }
+        return count;
+    };
+
+    BENCHMARK("Add (packed)")
+    {
+        auto sum = resistance::make_zero();
+        for (auto value : values)
+        {
+            sum = sum + value;
+        }
+        return sum.packed();
+    };
+
+    BENCHMARK("Add (scalar)")
+    {
+        auto sum = scalar_resistance::from(resistance::make_zero());
+        for (auto& value : scalar_values)
+        {
+            sum = sum + value;
+        }
+        return sum.fire + sum.cold + sum.lightning + sum.chaos;
+    };
+}
@@ -0,0 +1,60 @@
+#ifndef RECAP_TEST_HELPERS_HPP_
+#define RECAP_TEST_HELPERS_HPP_
+
+#include <vector>
+
+#include "catch_amalgamated.hpp"
+#include "recipe.hpp"
+#include "resistance.hpp"
+#include "assignment.hpp"
+
+// Small set of recipes for all slot types shared by tests of table decorators
+inline std::vector<recap::recipe> make_recipes()
+{
+    using namespace recap;
+
+    return std::vector<recipe>{
+        recipe{ resistance{ 0, 0, 0, 0 }, 0, recipe::SLOT_ALL },
+        recipe{ resistance{ 30, 0, 0, 0 }, 30, recipe::SLOT_ALL },
+        recipe{ resistance{ 0, 30, 0, 0 }, 30, recipe::SLOT_ALL },
+        recipe{ resistance{ 0, 0, 30, 0 }, 30, recipe::SLOT_ALL },
+        recipe{ resistance{ 20, 20, 0, 0 }, 10, recipe::SLOT_ARMOUR },
+        recipe{ resistance{ 20, 0, 20, 0 }, 10, recipe::SLOT_ARMOUR },
+        recipe{ resistance{ 0, 20, 20, 0 }, 10, recipe::SLOT_ARMOUR },
+        recipe{ resistance{ 10, 10, 10, 0 }, 9, recipe::SLOT_JEWELRY },
+        recipe{ resistance{ 15, 0, 0, 15 }, 30, recipe::SLOT_JEWELRY },
+    };
+}
+
+// Verify that @p assign is a valid assignment of recipes to @p slots which satisfies @p req
+inline void verify_assignment(
+    recap::resistance req, 
+    const std::vector<recap::recipe::slot_t>& slots, 
+    const recap::assignment& assign)
+{
+    if (assign.cost() >= recap::recipe::MAX_COST)
+    {
+        return; // no solution is a valid answer
+    }
+
+    REQUIRE(assign.assignments().size() <= slots.size());
+
+    std::size_t used_slots = 0;
+    recap::resistance total_res = recap::resistance::make_zero();
+    recap::recipe::cost_t cost = 0;
+    for (std::size_t i = 0; i < assign.assignments().size(); ++i)
+    {
+        const auto& item = assign.assignments()[i];
+        cost += item.used_recipe().cost();
+        total_res = total_res + item.used_recipe().resistances();
+
+        REQUIRE((used_slots & item.slot()) == 0);
+        used_slots |= item.slot();
+    }
+
+    // check that assignment doesn't lie about its cost
+    REQUIRE(cost == assign.cost());
+    REQUIRE(total_res >= req);
+}
+
+#endif // RECAP_TEST_HELPERS_HPP_